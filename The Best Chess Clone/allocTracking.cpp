@@ -0,0 +1,221 @@
+#include "allocTracking.h"
+
+#ifdef CHESS_ALLOC_TRACKING
+
+#include <array>
+#include <vector>
+#include <utility>
+#include <new>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+
+namespace
+{
+	constexpr int maxDepth{ 64 };			//nested scopes, deeper ones share the innermost tracked one's counts
+	constexpr int maxScopes{ 128 };			//distinct names per thread, the rest go under the last one
+	constexpr const char* untagged{ "untagged" };
+
+	struct ScopeCounts
+	{
+		const char* name{};
+		AllocTracking::Counts counts{};
+	};
+
+	//plain arrays, so a thread's state needs no allocation of its own and is ready before its first one
+	struct ThreadState
+	{
+		std::array<const char*, maxDepth> names{};
+		std::array<bool, maxDepth> isForbidden{};
+		int depth{ 0 };
+		AllocTracking::Counts total{};
+		std::array<ScopeCounts, maxScopes> scopes{};
+		int scopeCount{ 0 };
+		std::uint64_t violations{ 0 };
+		const char* lastViolation{ nullptr };
+	};
+
+	thread_local ThreadState s_state{};
+
+	//names are told apart by address, every scope's name being a literal of its own
+	ScopeCounts& getScope(const char* name)
+	{
+		for (int i{ 0 }; i < s_state.scopeCount; ++i)
+			if (s_state.scopes[static_cast<size_t>(i)].name == name)
+				return s_state.scopes[static_cast<size_t>(i)];
+
+		if (s_state.scopeCount == maxScopes)
+			return s_state.scopes[maxScopes - 1];
+
+		ScopeCounts& scope{ s_state.scopes[static_cast<size_t>(s_state.scopeCount++)] };
+		scope.name = name;
+
+		return scope;
+	}
+
+	void record(std::size_t bytes)
+	{
+		const int innermost{ std::min(s_state.depth, maxDepth) - 1 };
+		const char* name{ (innermost >= 0) ? s_state.names[static_cast<size_t>(innermost)] : untagged };
+
+		++s_state.total.allocations;
+		s_state.total.bytes += bytes;
+
+		AllocTracking::Counts& counts{ getScope(name).counts };
+		++counts.allocations;
+		counts.bytes += bytes;
+
+		if (innermost >= 0 && s_state.isForbidden[static_cast<size_t>(innermost)])
+		{
+			++s_state.violations;
+			s_state.lastViolation = name;
+		}
+	}
+
+	void* allocate(std::size_t bytes)
+	{
+		record(bytes);
+		return std::malloc((bytes > 0) ? bytes : 1);
+	}
+
+	void* allocate(std::size_t bytes, std::align_val_t alignment)
+	{
+		record(bytes);
+
+		const auto alignmentBytes{ static_cast<std::size_t>(alignment) };
+		const std::size_t roundedBytes{ ((bytes > 0 ? bytes : 1) + alignmentBytes - 1) / alignmentBytes * alignmentBytes };
+
+	#ifdef _MSC_VER
+		return _aligned_malloc(roundedBytes, alignmentBytes);
+	#else
+		return std::aligned_alloc(alignmentBytes, roundedBytes);
+	#endif
+	}
+
+	void deallocate(void* pointer, std::align_val_t)
+	{
+	#ifdef _MSC_VER
+		_aligned_free(pointer);
+	#else
+		std::free(pointer);
+	#endif
+	}
+}
+
+AllocTracking::Scope::Scope(const char* name, bool isForbidden)
+{
+	if (s_state.depth < maxDepth)
+	{
+		s_state.names[static_cast<size_t>(s_state.depth)] = name;
+		s_state.isForbidden[static_cast<size_t>(s_state.depth)] = isForbidden;
+	}
+
+	++s_state.depth;
+}
+
+AllocTracking::Scope::~Scope()
+{
+	--s_state.depth;
+}
+
+AllocTracking::Counts AllocTracking::getCounts()
+{
+	return s_state.total;
+}
+
+std::vector<std::pair<const char*, AllocTracking::Counts>> AllocTracking::getScopeCounts()
+{
+	//copied out first, the vector's own allocation is counted too
+	const ThreadState state{ s_state };
+	std::vector<std::pair<const char*, Counts>> scopes{};
+
+	scopes.reserve(static_cast<size_t>(state.scopeCount));
+
+	for (int i{ 0 }; i < state.scopeCount; ++i)
+		scopes.emplace_back(state.scopes[static_cast<size_t>(i)].name, state.scopes[static_cast<size_t>(i)].counts);
+
+	return scopes;
+}
+
+std::uint64_t AllocTracking::getViolations()
+{
+	return s_state.violations;
+}
+
+const char* AllocTracking::getLastViolation()
+{
+	return s_state.lastViolation;
+}
+
+//the open scopes stay open
+void AllocTracking::reset()
+{
+	s_state.total = {};
+	s_state.scopes = {};
+	s_state.scopeCount = 0;
+	s_state.violations = 0;
+	s_state.lastViolation = nullptr;
+}
+
+//every replaceable form, so nothing gets past the counts or is freed by the wrong function
+void* operator new(std::size_t bytes)
+{
+	if (void* pointer{ allocate(bytes) })
+		return pointer;
+
+	throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t bytes)
+{
+	return operator new(bytes);
+}
+
+void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept
+{
+	return allocate(bytes);
+}
+
+void* operator new[](std::size_t bytes, const std::nothrow_t&) noexcept
+{
+	return allocate(bytes);
+}
+
+void* operator new(std::size_t bytes, std::align_val_t alignment)
+{
+	if (void* pointer{ allocate(bytes, alignment) })
+		return pointer;
+
+	throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t bytes, std::align_val_t alignment)
+{
+	return operator new(bytes, alignment);
+}
+
+void* operator new(std::size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocate(bytes, alignment);
+}
+
+void* operator new[](std::size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocate(bytes, alignment);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t alignment) noexcept { deallocate(pointer, alignment); }
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept { deallocate(pointer, alignment); }
+void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept { deallocate(pointer, alignment); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t alignment) noexcept { deallocate(pointer, alignment); }
+void operator delete(void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept { deallocate(pointer, alignment); }
+void operator delete[](void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept { deallocate(pointer, alignment); }
+
+#endif
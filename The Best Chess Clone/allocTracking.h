@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+//heap allocations counted by the global operator new, and put down to the scope they were made in
+//
+//ALLOC_SCOPE("name") puts the thread's allocations in the rest of the enclosing block down to the name,
+//the innermost scope taking them. ALLOC_FORBID("name") does the same for a path that should never allocate,
+//and counts every allocation in it as a violation too, unless an ALLOC_SCOPE nested inside allows it.
+//Counts are per thread. Without CHESS_ALLOC_TRACKING defined the macros expand to nothing, operator new
+//is left alone and none of this is compiled.
+#ifdef CHESS_ALLOC_TRACKING
+	#define ALLOC_TRACKING(statement) statement
+#else
+	#define ALLOC_TRACKING(statement)
+#endif
+
+namespace AllocTracking
+{
+	struct Counts
+	{
+		std::uint64_t allocations{ 0 };
+		std::uint64_t bytes{ 0 };
+	};
+
+	constexpr bool isEnabled()
+	{
+	#ifdef CHESS_ALLOC_TRACKING
+		return true;
+	#else
+		return false;
+	#endif
+	}
+
+#ifdef CHESS_ALLOC_TRACKING
+
+	//names must outlive the program, which string literals do
+	class Scope
+	{
+		public:
+			explicit Scope(const char* name, bool isForbidden = false);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			void operator=(const Scope&) = delete;
+	};
+
+	//of this thread, since it started or last reset them
+	Counts getCounts();
+	std::vector<std::pair<const char*, Counts>> getScopeCounts();		//the ones outside any scope under "untagged"
+	std::uint64_t getViolations();
+	const char* getLastViolation();										//the forbidden scope, nullptr without violations
+	void reset();
+
+#endif
+}
+
+#ifdef CHESS_ALLOC_TRACKING
+	#define ALLOC_JOIN_IMPLEMENTATION(first, second) first##second
+	#define ALLOC_JOIN(first, second) ALLOC_JOIN_IMPLEMENTATION(first, second)
+	#define ALLOC_SCOPE(name) const AllocTracking::Scope ALLOC_JOIN(allocScope, __LINE__){ name }
+	#define ALLOC_FORBID(name) const AllocTracking::Scope ALLOC_JOIN(allocScope, __LINE__){ name, true }
+#else
+	#define ALLOC_SCOPE(name)
+	#define ALLOC_FORBID(name)
+#endif
@@ -0,0 +1,289 @@
+#include "bench.h"
+#include "board.h"
+#include "piece.h"
+#include "pawns.h"
+#include "transposition.h"
+#include "perfCounters.h"
+#include "allocTracking.h"
+#include "move.h"
+#include <iostream>
+#include <string_view>
+#include <array>
+#include <vector>
+#include <optional>
+#include <utility>
+#include <algorithm>
+#include <span>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+namespace
+{
+	//openings, middlegames and endgames, some with castling or en passant available
+	constexpr std::array<std::string_view, 50> positions
+	{
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+		"4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+		"rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+		"r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+		"r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+		"r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+		"r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+		"4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+		"2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+		"r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+		"3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+		"r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+		"4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+		"3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+		"6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/3N4 b - - 0 1",
+		"3b4/5kp1/1p1p1p1p/pP1PpP1P/P1P1P3/3KN3/8/8 w - - 0 1",
+		"2K5/p7/7P/5pR1/8/5k2/r7/8 w - - 0 1",
+		"8/6pk/1p6/8/PP3p1p/5P2/4KP1q/3Q4 w - - 0 1",
+		"7k/3p2pp/4q3/8/4Q3/5Kp1/P6b/8 w - - 0 1",
+		"8/2p5/8/2kPKp1p/2p4P/2P5/3P4/8 w - - 0 1",
+		"8/1p3pp1/7p/5P1P/2k3P1/8/2K2P2/8 w - - 0 1",
+		"8/pp2r1k1/2p1p3/3pP2p/1P1P1P1P/P5KR/8/8 w - - 0 1",
+		"8/3p4/p1bk3p/Pp6/1Kp1PpPp/2P2P1P/2P5/5B2 b - - 0 1",
+		"5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
+		"6k1/6p1/P6p/r1N5/5p2/7P/1b3PP1/4R1K1 w - - 0 1",
+		"1r3k2/4q3/2Pp3b/3Bp3/2Q2p2/1p1P2P1/1P2KP2/3N4 w - - 0 1",
+		"6k1/4pp1p/3p2p1/P1pPb3/R7/1r2P1PP/3B1P2/6K1 w - - 0 1",
+		"8/3p3B/5p2/5P2/p7/PP5b/k7/6K1 w - - 0 1",
+		"5rk1/q6p/2p3bR/1pPp1rP1/1P1Pp3/P3B1Q1/1K3P2/R7 w - - 93 90",
+		"4rrk1/1p1nq3/p7/2p1P1pp/3P2bp/3Q1Bn1/PPPB4/1K2R1NR w - - 40 21",
+		"r3k2r/3nnpbp/q2pp1p1/p7/Pp1PPPP1/4BNN1/1P5P/R2Q1RK1 w kq - 0 16",
+		"3Qb1k1/1r2ppb1/pN1n2q1/Pp1Pp1Pr/4P2p/4BP2/4B1R1/1R5K b - - 11 40",
+		"4k3/3q1r2/1N2r1b1/3ppN2/2nPP3/1B1R2n1/2R1Q3/3K4 w - - 5 1",
+		"8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+		"8/3k4/8/8/8/4B3/4KB2/2B5 w - - 0 1",
+		"8/8/1P6/5pr1/8/4R3/7k/2K5 w - - 0 1",
+		"8/2p4P/8/kr6/6R1/8/8/1K6 w - - 0 1",
+		"8/8/3P3k/8/1p6/8/1P6/1K3n2 b - - 0 1",
+		"8/R7/2q5/8/6k1/8/1P5p/K6R w - - 0 124",
+		"6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1",
+		"r2r1n2/pp2bk2/2p1p2p/3q4/3PN1QP/2P3R1/P4PP1/5RK1 w - - 0 1",
+		"rnbqkb1r/ppp1pppp/5n2/3p4/3P4/5N2/PPP1PPPP/RNBQKB1R w KQkq - 2 3",
+		"r1bqkbnr/pppp1ppp/2n5/1B2p3/4P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3",
+		"rnbqkb1r/pp2pppp/3p1n2/8/3NP3/8/PPP2PPP/RNBQKB1R w KQkq - 1 5",
+		"r1bqk2r/pppp1ppp/2n2n2/2b1p3/2B1P3/3P1N2/PPP2PPP/RNBQK2R w KQkq - 1 5",
+		"rnbq1rk1/ppp1bppp/4pn2/3p2B1/2PP4/2N2N2/PP2PPPP/R2QKB1R w KQ - 4 6",
+		"r2q1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ - 3 10",
+		"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+	};
+
+	std::uint64_t perft(Board& board, int depth)
+	{
+		const std::vector<Move> moves{ board.getLegalMoves() };
+
+		if (depth <= 1)
+			return moves.size();
+
+		std::uint64_t nodes{ 0 };
+
+		//there's no unmake, so every move gets a copy of the board
+		for (const Move move : moves)
+		{
+			Board child{ board };
+			child.makeMove(move);
+			nodes += perft(child, depth - 1);
+		}
+
+		return nodes;
+	}
+
+	std::optional<int> parseDepth(std::span<char* const> arguments, int defaultDepth)
+	{
+		const int depth{ (arguments.size() == 1) ? std::atoi(arguments[0]) : defaultDepth };
+
+		if (arguments.size() > 1 || depth <= 0)
+			return std::nullopt;
+
+		return depth;
+	}
+
+	void printResult(const Bench::Result& result, int depth)
+	{
+		const double seconds{ std::chrono::duration<double>(result.time).count() };
+
+		std::cout << "Depth " << depth << '\n'
+			<< "Nodes searched  : " << result.nodes << '\n'
+			<< "Time (ms)       : " << std::chrono::duration_cast<std::chrono::milliseconds>(result.time).count() << '\n'
+			<< "Nodes/second    : " << static_cast<std::uint64_t>(static_cast<double>(result.nodes) / std::max(seconds, 1e-9)) << '\n';
+	}
+
+	//whatever the machine let be counted, a restricted container may allow none
+	void printCounters(const PerfCounters::Reading& counters, std::uint64_t nodes)
+	{
+		bool isCounted{ false };
+
+		if (const auto ipc{ counters.getIpc() })
+		{
+			std::cout << "IPC             : " << ipc.value() << '\n';
+			isCounted = true;
+		}
+
+		for (std::size_t i{ 0 }; i < PerfCounters::eventCount; ++i)
+		{
+			const auto event{ static_cast<PerfCounters::Event>(i) };
+
+			if (const auto perNode{ counters.getPer(event, nodes) })
+			{
+				std::cout << PerfCounters::getName(event) << "/node : " << perNode.value() << '\n';
+				isCounted = true;
+			}
+		}
+
+		if (!isCounted)
+			std::cout << "Counters        : unavailable\n";
+	}
+
+	//the scopes that allocate the most first, false when a forbidden one allocated at all
+	bool printAllocations(const Bench::Result& result)
+	{
+		if constexpr (!AllocTracking::isEnabled())
+			return true;
+
+		constexpr std::size_t printedScopes{ 10 };
+		const double nodes{ static_cast<double>(std::max(result.nodes, std::uint64_t{ 1 })) };
+		auto scopes{ result.allocationScopes };
+
+		std::sort(scopes.begin(), scopes.end(), [](const auto& a, const auto& b) { return a.second.allocations > b.second.allocations; });
+
+		std::cout << "Allocations/node: " << static_cast<double>(result.allocations.allocations) / nodes << '\n'
+			<< "Bytes/node      : " << static_cast<double>(result.allocations.bytes) / nodes << '\n';
+
+		for (std::size_t i{ 0 }; i < std::min(scopes.size(), printedScopes); ++i)
+			std::cout << "  " << scopes[i].first << " : " << static_cast<double>(scopes[i].second.allocations) / nodes << "/node\n";
+
+		if (result.forbiddenAllocations == 0)
+			return true;
+
+		std::cout << "Forbidden allocations: " << result.forbiddenAllocations << ", last in " << result.forbiddenScope << '\n';
+		return false;
+	}
+
+#ifdef CHESS_ALLOC_TRACKING
+	//what a timed region allocated, from the counts before it
+	void addAllocations(Bench::Result& result, const AllocTracking::Counts& initialCounts)
+	{
+		result.allocations.allocations += AllocTracking::getCounts().allocations - initialCounts.allocations;
+		result.allocations.bytes += AllocTracking::getCounts().bytes - initialCounts.bytes;
+	}
+
+	void finishAllocations(Bench::Result& result)
+	{
+		result.allocationScopes = AllocTracking::getScopeCounts();
+		result.forbiddenAllocations = AllocTracking::getViolations();
+		result.forbiddenScope = AllocTracking::getLastViolation();
+	}
+#endif
+}
+
+Bench::Result Bench::run(int depth)
+{
+	Result result{};
+
+	//depth is counted in plies, the search's deepness in plies after the first one
+	const Board::SearchLimits limits{ std::max(depth, 1) - 1 };
+
+	//the signature shouldn't depend on what ran before in the same process
+	Transposition::clear();
+	Pawns::resetStats();
+	ALLOC_TRACKING(AllocTracking::reset());
+
+	PerfCounters counters{};
+
+	for (std::size_t i{ 0 }; i < positions.size(); ++i)
+	{
+		Board board{ Board::fromFen(positions[i], Piece::Color::White).value() };
+
+		const auto startTime{ std::chrono::steady_clock::now() };
+		ALLOC_TRACKING(const AllocTracking::Counts initialAllocations{ AllocTracking::getCounts() });
+		counters.start();
+		board.makeAIMove(limits);
+		counters.stop();
+		ALLOC_TRACKING(addAllocations(result, initialAllocations));
+		result.time += std::chrono::steady_clock::now() - startTime;
+
+		const std::uint64_t nodes{ board.getSearchNodes() };
+		result.nodes += nodes;
+
+		std::clog << "Position " << i + 1 << '/' << positions.size() << "  nodes " << nodes << '\n';
+	}
+
+	result.pawnHitRate = Pawns::getStats().getHitRate();
+	result.counters = counters.read();
+	ALLOC_TRACKING(finishAllocations(result));
+
+	return result;
+}
+
+Bench::Result Bench::runPerft(int depth)
+{
+	Result result{};
+	PerfCounters counters{};
+
+	ALLOC_TRACKING(AllocTracking::reset());
+
+	for (std::size_t i{ 0 }; i < positions.size(); ++i)
+	{
+		Board board{ Board::fromFen(positions[i], Piece::Color::White).value() };
+
+		const auto startTime{ std::chrono::steady_clock::now() };
+		ALLOC_TRACKING(const AllocTracking::Counts initialAllocations{ AllocTracking::getCounts() });
+		counters.start();
+		const std::uint64_t nodes{ perft(board, depth) };
+		counters.stop();
+		ALLOC_TRACKING(addAllocations(result, initialAllocations));
+		result.time += std::chrono::steady_clock::now() - startTime;
+		result.nodes += nodes;
+
+		std::clog << "Position " << i + 1 << '/' << positions.size() << "  nodes " << nodes << '\n';
+	}
+
+	result.counters = counters.read();
+	ALLOC_TRACKING(finishAllocations(result));
+
+	return result;
+}
+
+int Bench::runCommand(std::span<char* const> arguments)
+{
+	const auto depth{ parseDepth(arguments, defaultDepth) };
+
+	if (!depth)
+	{
+		std::cout << "usage: bench [depth]\n";
+		return 1;
+	}
+
+	const Result result{ run(depth.value()) };
+
+	printResult(result, depth.value());
+	std::cout << "Pawn hash hits  : " << result.pawnHitRate * 100.0 << "%\n";
+	printCounters(result.counters, result.nodes);
+
+	return printAllocations(result) ? 0 : 1;
+}
+
+int Bench::runPerftCommand(std::span<char* const> arguments)
+{
+	const auto depth{ parseDepth(arguments, defaultPerftDepth) };
+
+	if (!depth)
+	{
+		std::cout << "usage: perft [depth]\n";
+		return 1;
+	}
+
+	const Result result{ runPerft(depth.value()) };
+
+	printResult(result, depth.value());
+	printCounters(result.counters, result.nodes);
+
+	return printAllocations(result) ? 0 : 1;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "perfCounters.h"
+#include "allocTracking.h"
+#include <span>
+#include <vector>
+#include <utility>
+#include <chrono>
+#include <cstdint>
+
+//end to end benchmark: a fixed set of positions, each searched by Board::makeAIMove to a fixed depth
+//
+//the node total is a signature of the search, any change to what it does changes it, and the time
+//gives the build's speed. It runs on one thread, without the opening book or a network loaded.
+//Perft does the same for move generation alone. Both read the hardware counters where they can, and
+//builds tracking allocations report them per node, failing when a path meant not to allocate did.
+namespace Bench
+{
+	inline constexpr int defaultDepth{ 3 };		//in plies
+	inline constexpr int defaultPerftDepth{ 3 };
+
+	struct Result
+	{
+		std::uint64_t nodes{ 0 };
+		std::chrono::nanoseconds time{};
+		double pawnHitRate{ 0.0 };		//of the pawn structure table's probes
+		PerfCounters::Reading counters{};	//of the timed regions only
+		AllocTracking::Counts allocations{};	//of the timed regions, with CHESS_ALLOC_TRACKING
+		std::vector<std::pair<const char*, AllocTracking::Counts>> allocationScopes{};	//of the whole run
+		std::uint64_t forbiddenAllocations{ 0 };
+		const char* forbiddenScope{ nullptr };	//the last one allocated in
+	};
+
+	Result run(int depth);
+
+	//every legal line of the positions to the depth, with the lines as nodes
+	Result runPerft(int depth);
+
+	//the bench [depth] and perft [depth] commands, given the arguments after their name
+	int runCommand(std::span<char* const> arguments);
+	int runPerftCommand(std::span<char* const> arguments);
+}
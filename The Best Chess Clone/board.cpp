@@ -1,7 +1,17 @@
 #include "board.h"
 #include "piece.h"
 #include "coordinates.h"
+#include "move.h"
 #include "constants.h"
+#include "evalParams.h"
+#include "book.h"
+#include "movePicker.h"
+#include "transposition.h"
+#include "kpk.h"
+#include "learning.h"
+#include "mateSolver.h"
+#include "trace.h"
+#include "allocTracking.h"
 #include <algorithm>
 #include <array>
 #include <utility>
@@ -10,6 +20,12 @@
 #include <cctype>
 #include <optional>
 #include <cmath>
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <bit>
+#include <future>
+#include <atomic>
 
 Board::Board(Piece::Color playerColor)
 	: m_playerColor{ playerColor }, m_matrix
@@ -26,11 +42,6 @@ Board::Board(Piece::Color playerColor)
 		}
 	}
 {
-	Piece::setPlayerColor(playerColor);
-
-	m_whitePieces.reserve(Constants::piecesPerColor);
-	m_blackPieces.reserve(Constants::piecesPerColor);
-	
 	if (playerColor == Piece::Color::Black)
 	{
 		std::swap(m_matrix(0, 3), m_matrix(0, 4));
@@ -49,407 +60,1570 @@ Board::Board(Piece::Color playerColor)
 			if (playerColor == Piece::Color::Black)
 				letter = static_cast<char>((letter == toupper(letter)) ? tolower(letter) : (toupper(letter)));
 			
-			auto& list{ getListFromColor(Piece::getColor(letter)) };
-
-			list.push_back(Piece::toPiece(letter, { i, j }, false));
+			addPieceToList(letter, { i, j }, false);		//16 a side, always room
+			m_materialSignature += getMaterialUnit(letter);
 		}
 	}
+
+	m_positionKey = computePositionKey();
+	m_pawnKey = computePawnKey();
+	m_keyHistory.reserve(Constants::expectedGamePlies);
 }
 
-std::vector<const Piece*> Board::getPieces()
+std::optional<Board> Board::fromFen(std::string_view fen, Piece::Color player)
 {
-	std::vector<const Piece*> pieces{};
+	constexpr auto swapCase{ [](char letter) { return static_cast<char>(std::isupper(static_cast<unsigned char>(letter)) ? std::tolower(letter) : std::toupper(letter)); } };
+	constexpr auto nextField
+	{
+		[](std::string_view& text)
+		{
+			while (!text.empty() && text.front() == ' ')
+				text.remove_prefix(1);
 
-	pieces.reserve(m_whitePieces.size() + m_blackPieces.size());
+			const size_t end{ std::min(text.find(' '), text.size()) };
+			const std::string_view field{ text.substr(0, end) };
+			text.remove_prefix(end);
+			return field;
+		}
+	};
 
-	for (const auto& piece : m_whitePieces)
-		pieces.push_back(piece.get());
+	const std::string_view placement{ nextField(fen) };
+	const std::string_view side{ nextField(fen) };
+	const std::string_view castling{ nextField(fen) };
+	const std::string_view enPassant{ nextField(fen) };
+	const std::string_view halfmoveClock{ nextField(fen) };
 
-	for (const auto& piece : m_blackPieces)
-		pieces.push_back(piece.get());
+	if (side != "w" && side != "b")
+		return std::nullopt;
 
-	return pieces;
-}
+	//kings and rooks keep their castling rights by being flagged as not moved yet
+	std::array<bool, Constants::array2dSize> canCastle{};
 
-Piece::Color Board::getPlayerColor() const
-{
-	return m_playerColor;
-}
+	for (const char right : castling)
+	{
+		switch (right)
+		{
+			case 'K': canCastle[4] = canCastle[7] = true; break;
+			case 'Q': canCastle[4] = canCastle[0] = true; break;
+			case 'k': canCastle[60] = canCastle[63] = true; break;
+			case 'q': canCastle[60] = canCastle[56] = true; break;
+			case '-': break;
+			default: return std::nullopt;
+		}
+	}
 
-char Board::operator()(const Coordinates& coordinates) const
-{
-	return m_matrix(coordinates);
-}
+	Board board{ player };
+	BoardMatrix::Array2d emptyMatrix{};
+	emptyMatrix.fill('x');
 
-void Board::makeMove(const Coordinates& oldCoordinates, const Coordinates& newCoordinates)
-{
-	char& newSquare{ m_matrix(newCoordinates) };
-	const auto& piece = getPieceFromList(oldCoordinates);
-	constexpr auto isCastling{ [](Coordinates king, Coordinates move) { return abs(king.y - move.y) > 1; } };
-	bool makeRookCastlingMove{ false };
-	constexpr auto getPromotionRank{ [](Piece::Color player, Piece::Color promotion) { return player == promotion ? 0 : Constants::squaresPerLine - 1; } };
+	board.m_matrix = BoardMatrix{ emptyMatrix };
+	board.m_whitePieces.clear();
+	board.m_blackPieces.clear();
+	board.m_materialSignature = 0;
 
-	if (Piece::isPiece(newSquare))
-	{
-		erasePieceFromList(newCoordinates);
-	}
-	else if (isEnPassant(newCoordinates, piece->getColor()) && piece->getType() == Piece::Type::Pawn)
-	{	
-		Coordinates rivalPawnCoordinates{ newCoordinates + Coordinates{ Piece::getForwardDirection(!piece->getColor()), 0 } };
-		erasePieceFromList(rivalPawnCoordinates);
-		m_matrix(rivalPawnCoordinates) = 'x';
-	}
-	else if (piece->getType() == Piece::Type::King && isCastling(oldCoordinates, newCoordinates))
+	int rank{ Constants::squaresPerLine - 1 };
+	int file{ 0 };
+	std::array<int, 2> kingCount{};
+	std::array<int, 2> pieceCount{};
+
+	for (const char character : placement)
 	{
-		makeRookCastlingMove = true;
-	}
+		if (character == '/')
+		{
+			if (file != Constants::squaresPerLine || rank == 0)
+				return std::nullopt;
 
-	m_enPassant = std::nullopt;
+			--rank;
+			file = 0;
+		}
+		else if (character >= '1' && character <= '8')
+		{
+			file += character - '0';
+		}
+		else
+		{
+			if (file >= Constants::squaresPerLine || std::string_view{ "pnbrqkPNBRQK" }.find(character) == std::string_view::npos)
+				return std::nullopt;
 
-	if (!piece->hasMoved())
-	{
-		piece->addMovedFlag();
+			const char letter{ swapCase(character) };
+			const int square{ rank * Constants::squaresPerLine + file };
+			const Coordinates coordinates{ board.toCoordinates(square) };
+			const Piece::Type type{ Piece::getType(letter) };
+			const Piece::Color color{ Piece::getColor(letter) };
 
-		if (piece->getType() == Piece::Type::Pawn)
-			m_enPassant = EnPassant{ oldCoordinates + Coordinates{ Piece::getForwardDirection(piece->getColor()), 0 }, !piece->getColor() };
-	}
+			bool hasMoved{ false };
 
-	piece->getCoordinates() = newCoordinates;
-	newSquare = m_matrix(oldCoordinates);
-	m_matrix(oldCoordinates) = 'x';
+			if (type == Piece::Type::Pawn)
+				hasMoved = rank != ((color == Piece::Color::White) ? 1 : Constants::squaresPerLine - 2);
+			else if (type == Piece::Type::King || type == Piece::Type::Rook)
+				hasMoved = !canCastle[static_cast<size_t>(square)];
 
-	if (piece->getType() == Piece::Type::Pawn && getPromotionRank(m_playerColor, piece->getColor()) == newCoordinates.x)
-	{
-		auto& list{ getListFromColor(piece->getColor()) };
-		char queenLetter{ piece->getColor() == Piece::Color::White ? 'q' : 'Q' };
-		erasePieceFromList(newCoordinates);
-		list.push_back(Piece::toPiece(queenLetter, newCoordinates, true));
+			//no more than a side starts with, and no pawn where it can't stand
+			if (++pieceCount[static_cast<size_t>(color)] > Constants::piecesPerColor)
+				return std::nullopt;
+
+			if (type == Piece::Type::Pawn && (rank == 0 || rank == Constants::squaresPerLine - 1))
+				return std::nullopt;
+
+			if (type == Piece::Type::King)
+				++kingCount[static_cast<size_t>(color)];
+
+			board.m_matrix(coordinates) = letter;
+
+			if (!board.addPieceToList(letter, coordinates, hasMoved))
+				return std::nullopt;
+
+			board.m_materialSignature += getMaterialUnit(letter);
+			++file;
+		}
 	}
-	
-	if (makeRookCastlingMove)
+
+	if (rank != 0 || file != Constants::squaresPerLine || kingCount[0] != 1 || kingCount[1] != 1)
+		return std::nullopt;
+
+	board.m_colorToMove = (side == "w") ? Piece::Color::White : Piece::Color::Black;
+
+	if (enPassant != "-")
 	{
-		int castlingDirection{ (newCoordinates > oldCoordinates) ? 1 : -1 };
-		Coordinates rookCoordinates{ (castlingDirection == 1) ? Coordinates{oldCoordinates.x, Constants::squaresPerLine - 1 } : Coordinates{oldCoordinates.x, 0 } };
-		Coordinates rookMove{ newCoordinates - Coordinates{ 0, castlingDirection } };
-		makeMove(rookCoordinates, rookMove);
+		if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' || enPassant[1] < '1' || enPassant[1] > '8')
+			return std::nullopt;
+
+		const int square{ (enPassant[1] - '1') * Constants::squaresPerLine + (enPassant[0] - 'a') };
+		board.m_enPassant = EnPassant{ board.toCoordinates(square), board.m_colorToMove };
 	}
-}
 
-std::vector<Coordinates> Board::getMoves(const Coordinates& coordinates)
-{
-	return getPieceFromList(coordinates)->getMoves(*this);
-}
+	if (!halfmoveClock.empty())
+		std::from_chars(halfmoveClock.data(), halfmoveClock.data() + halfmoveClock.size(), board.m_halfmoveClock);
 
-bool Board::isEnPassant(const Coordinates& coordinates, Piece::Color color) const
-{
-	return (m_enPassant) ? m_enPassant->coordinates == coordinates && m_enPassant->movingColor == color : false;
+	board.m_positionKey = board.computePositionKey();
+	board.m_pawnKey = board.computePawnKey();
+
+	return board;
 }
 
-bool Board::isLegalMove(const Coordinates& oldCoordinates, const Coordinates& newCoordinates) const
+std::string Board::getFen() const
 {
-	//todo: refactore and make it functional for en passants 
+	std::string fen{};
+
+	for (int rank{ Constants::squaresPerLine - 1 }; rank >= 0; --rank)
+	{
+		int emptySquares{ 0 };
 
-	char& currentPosition{ m_matrix(oldCoordinates) };
-	char& attackedPosition{ m_matrix(newCoordinates) };
-	const char currentLetter{ m_matrix(oldCoordinates) };
-	const char attackedLetter{ m_matrix(newCoordinates) };
+		for (int file{ 0 }; file < Constants::squaresPerLine; ++file)
+		{
+			const char letter{ m_matrix(toCoordinates(rank * Constants::squaresPerLine + file)) };
 
-	const Piece::Color pieceColor{ Piece::getColor(currentLetter) };
+			if (!Piece::isPiece(letter))
+			{
+				++emptySquares;
+				continue;
+			}
 
-	const auto& thisColorList{ getListFromColor(pieceColor) };
-	const auto& rivalColorList{ getListFromColor(!pieceColor) };
+			if (emptySquares > 0)
+				fen += static_cast<char>('0' + std::exchange(emptySquares, 0));
 
-	currentPosition = 'x';
-	attackedPosition = currentLetter;
+			fen += static_cast<char>(std::isupper(static_cast<unsigned char>(letter)) ? std::tolower(letter) : std::toupper(letter));
+		}
 
-	std::vector<Piece*> attackingPieces{};
-	attackingPieces.reserve(rivalColorList.size());
-	
-	for (const auto& piece : rivalColorList)
-		if (piece->getCoordinates() != newCoordinates)
-			attackingPieces.push_back(piece.get());
+		if (emptySquares > 0)
+			fen += static_cast<char>('0' + emptySquares);
 
-	const bool isKing{ Piece::getType(currentLetter) == Piece::Type::King };
+		if (rank > 0)
+			fen += '/';
+	}
+
+	fen += (m_colorToMove == Piece::Color::White) ? " w " : " b ";
+
+	const size_t castlingStart{ fen.size() };
+
+	if (hasCastlingRight(4, 7))
+		fen += 'K';
+	if (hasCastlingRight(4, 0))
+		fen += 'Q';
+	if (hasCastlingRight(60, 63))
+		fen += 'k';
+	if (hasCastlingRight(60, 56))
+		fen += 'q';
+	if (fen.size() == castlingStart)
+		fen += '-';
 
-	Coordinates kingCoordinates{};
+	fen += ' ';
 
-	if (isKing) 
+	if (m_enPassant)
 	{
-		kingCoordinates = newCoordinates;
+		const int square{ toSquare(m_enPassant->coordinates) };
+		fen += static_cast<char>('a' + square % Constants::squaresPerLine);
+		fen += static_cast<char>('1' + square / Constants::squaresPerLine);
 	}
 	else
 	{
-		for (const auto& piece : thisColorList)
-			if (piece->getType() == Piece::Type::King)
-			{
-				kingCoordinates = piece->getCoordinates();
-				break;
-			}
+		fen += '-';
 	}
 
-	bool isLegal{ true };
-
-	for (const auto& piece : attackingPieces)
-		for (const auto& attack : piece->getAttacks(*this))
-			if (attack == kingCoordinates)
-			{
-				isLegal = false;
-				break;
-			}
-			
-	currentPosition = currentLetter;
-	attackedPosition = attackedLetter;
+	fen += ' ' + std::to_string(m_halfmoveClock) + ' ' + std::to_string(getFullmoveNumber());
 
-	return isLegal;
+	return fen;
 }
 
-bool Board::isAttacked(const Coordinates& coordinates) const
+//goes through a FEN, which already checks everything a position needs
+std::optional<Board> Board::fromPacked(const PackedPosition& position, Piece::Color player)
 {
-	Piece::Color color{ Piece::getColor(m_matrix(coordinates)) };
-	return isAttackedBy(coordinates, !color);
-}
+	constexpr std::string_view letters{ "?PNBRQK??pnbrqk?" };	//by code
+	std::string fen{};
 
-bool Board::isAttackedBy(const Coordinates& coordinates, Piece::Color color) const
-{
-	for (const auto& piece : getListFromColor(color))
+	for (int rank{ Constants::squaresPerLine - 1 }; rank >= 0; --rank)
 	{
-		for (const auto& attack : piece->getAttacks(*this))
+		int emptySquares{ 0 };
+
+		for (int file{ 0 }; file < Constants::squaresPerLine; ++file)
 		{
-			if (attack == coordinates)
-				return true;
+			const int square{ rank * Constants::squaresPerLine + file };
+			const std::uint64_t squareBit{ std::uint64_t{ 1 } << square };
+
+			if ((position.occupancy & squareBit) == 0)
+			{
+				++emptySquares;
+				continue;
+			}
+
+			if (emptySquares > 0)
+				fen += static_cast<char>('0' + std::exchange(emptySquares, 0));
+
+			//pieces are stored from a1 up, so a piece's index is how many come before its square
+			fen += letters[static_cast<size_t>(position.getCode(std::popcount(position.occupancy & (squareBit - 1))))];
 		}
+
+		if (emptySquares > 0)
+			fen += static_cast<char>('0' + emptySquares);
+
+		if (rank > 0)
+			fen += '/';
 	}
 
-	return false;
+	fen += (position.state & PackedPosition::blackToMove) ? " b " : " w ";
+
+	const size_t castlingStart{ fen.size() };
+
+	for (size_t i{ 0 }; i < PackedPosition::castlingRights.size(); ++i)
+		if (position.state & PackedPosition::castlingRights[i])
+			fen += "KQkq"[i];
+
+	if (fen.size() == castlingStart)
+		fen += '-';
+
+	fen += ' ';
+	fen += (position.enPassant < Constants::array2dSize) ? Move::getSquareName(position.enPassant) : "-";
+	fen += ' ' + std::to_string(position.halfmoveClock) + " 1";
+
+	return fromFen(fen, player);
 }
 
-void Board::erasePieceFromList(const Coordinates& coordinates)
+PackedPosition Board::pack() const
 {
-	char letter{ m_matrix(coordinates) };
-	auto& list{ getListFromColor(Piece::getColor(letter)) };
+	PackedPosition position{};
+	int index{ 0 };
 
-	auto piece
+	for (int square{ 0 }; square < Constants::array2dSize; ++square)
 	{
-		std::find_if(list.begin(), list.end(), [&](const std::unique_ptr<Piece>& piece)
-		{
-			return piece->getCoordinates() == coordinates;
-		})
-	};
+		const char letter{ m_matrix(toCoordinates(square)) };
+
+		if (!Piece::isPiece(letter))
+			continue;
+
+		position.occupancy |= std::uint64_t{ 1 } << square;
+		position.setCode(index++, PackedPosition::getCode(Piece::getType(letter), Piece::getColor(letter)));
+	}
+
+	if (m_colorToMove == Piece::Color::Black)
+		position.state |= PackedPosition::blackToMove;
 
-	list.erase(piece);
+	constexpr std::array<std::array<int, 2>, 4> castlingSquares{ { { 4, 7 }, { 4, 0 }, { 60, 63 }, { 60, 56 } } };	//king and rook, in FEN order
+
+	for (size_t i{ 0 }; i < castlingSquares.size(); ++i)
+		if (hasCastlingRight(castlingSquares[i][0], castlingSquares[i][1]))
+			position.state |= PackedPosition::castlingRights[i];
+
+	if (m_enPassant)
+		position.enPassant = static_cast<std::uint8_t>(toSquare(m_enPassant->coordinates));
+
+	position.halfmoveClock = static_cast<std::uint8_t>(std::min(m_halfmoveClock, 255));
+
+	return position;
 }
 
-Piece* Board::getPieceFromList(const Coordinates& coordinates)
+std::vector<const Piece*> Board::getPieces()
 {
-	const char letter{ m_matrix(coordinates) };
-	const auto& list{ getListFromColor(Piece::getColor(letter)) };
+	ALLOC_SCOPE("Board::getPieces");
 
-	auto piece
-	{
-		std::find_if(list.begin(), list.end(), [&](const std::unique_ptr<Piece>& piece)
-		{
-			return piece->getCoordinates() == coordinates;
-		})
-	};
+	std::vector<const Piece*> pieces{};
+
+	pieces.reserve(static_cast<size_t>(m_whitePieces.size() + m_blackPieces.size()));
 
-	return piece->get();
+	for (const auto* piece : m_whitePieces)
+		pieces.push_back(piece);
+
+	for (const auto* piece : m_blackPieces)
+		pieces.push_back(piece);
+
+	return pieces;
 }
 
-bool Board::isFromPlayer(const Coordinates& coordinates) const
+Piece::Color Board::getPlayerColor() const
 {
-	const char letter{ m_matrix(coordinates.x, coordinates.y) };
-	return Piece::isPiece(letter) && Piece::getColor(letter) == m_playerColor;
+	return m_playerColor;
 }
 
-bool Board::isOutOfBounds(const Coordinates& coordinates)
+//pawns move up the player's screen and down the other side's
+int Board::getForwardDirection(Piece::Color color) const
 {
-	return coordinates < Coordinates{ 0, 0 } || coordinates > Coordinates{ Constants::squaresPerLine - 1, Constants::squaresPerLine - 1 };
+	return (m_playerColor == color) ? -1 : 1;
 }
 
-const std::vector<std::unique_ptr<Piece>>& Board::getListFromColor(Piece::Color color) const
+Piece::Color Board::getColorToMove() const
 {
-	return (color == Piece::Color::White) ? m_whitePieces : m_blackPieces;
+	return m_colorToMove;
 }
 
-std::vector<std::unique_ptr<Piece>>& Board::getListFromColor(Piece::Color color)
+Zobrist::Key Board::getPositionKey() const
 {
-	return (color == Piece::Color::White) ? m_whitePieces : m_blackPieces;
+	return m_positionKey;
 }
 
-bool Board::isKingChecked(Piece::Color color) const
+//counted from the start of the game, a position set up from a FEN starts over at 1
+int Board::getFullmoveNumber() const
 {
-	const auto& kingList{ getListFromColor(color) };
+	return 1 + static_cast<int>(m_keyHistory.size()) / 2;
+}
+
+char Board::operator()(const Coordinates& coordinates) const
+{
+	return m_matrix(coordinates);
+}
 
-	auto king 
+//the flags are read off the board as it stands, so this has to be called before the move is made
+Move Board::createMove(const Coordinates& oldCoordinates, const Coordinates& newCoordinates, Piece::Type promotionType) const
+{
+	const char letter{ m_matrix(oldCoordinates) };
+	const Piece::Type type{ Piece::getType(letter) };
+	const bool isCapture{ Piece::isPiece(m_matrix(newCoordinates)) };
+
+	const int from{ toSquare(oldCoordinates) };
+	const int to{ toSquare(newCoordinates) };
+	const int toRank{ to / Constants::squaresPerLine };
+	const int fileDistance{ to % Constants::squaresPerLine - from % Constants::squaresPerLine };
+
+	Move::Flag flag{ isCapture ? Move::Flag::Capture : Move::Flag::Quiet };
+
+	if (type == Piece::Type::Pawn)
 	{
-		std::find_if(kingList.begin(), kingList.end(), [&](const std::unique_ptr<Piece>& piece)
-			{
-				return piece->getType() == Piece::Type::King;
-			})
-	};
+		if (toRank == 0 || toRank == Constants::squaresPerLine - 1)
+			flag = Move::getPromotionFlag(promotionType, isCapture);
+		else if (isEnPassant(newCoordinates, Piece::getColor(letter)))
+			flag = Move::Flag::EnPassant;
+		else if (abs(toRank - from / Constants::squaresPerLine) == 2)
+			flag = Move::Flag::DoublePawnPush;
+	}
+	else if (type == Piece::Type::King && abs(fileDistance) == 2)
+	{
+		flag = (fileDistance > 0) ? Move::Flag::KingCastle : Move::Flag::QueenCastle;
+	}
 
-	return isAttacked(king->get()->getCoordinates());
+	return Move{ from, to, flag };
 }
 
-bool Board::isKingMated(Piece::Color color)
+//coordinate notation, as in e2e4 or e7e8q; whether the move is legal is left to isValidMove
+std::optional<Move> Board::parseMove(std::string_view text) const
 {
-	const auto& kingList{ getListFromColor(color) };
+	if (text.size() != 4 && text.size() != 5)
+		return std::nullopt;
 
-	auto king
+	const auto parseSquare
 	{
-		std::find_if(kingList.begin(), kingList.end(), [&](const std::unique_ptr<Piece>& piece)
-			{
-				return piece->getType() == Piece::Type::King;
-			})
+		[](std::string_view name) -> std::optional<int>
+		{
+			if (name[0] < 'a' || name[0] > 'h' || name[1] < '1' || name[1] > '8')
+				return std::nullopt;
+
+			return (name[1] - '1') * Constants::squaresPerLine + (name[0] - 'a');
+		}
 	};
 
-	if (isAttacked(king->get()->getCoordinates()))
+	const auto from{ parseSquare(text.substr(0, 2)) };
+	const auto to{ parseSquare(text.substr(2, 2)) };
+
+	if (!from || !to || !Piece::isPiece(m_matrix(toCoordinates(from.value()))))
+		return std::nullopt;
+
+	Piece::Type promotionType{ Piece::Type::Queen };
+
+	if (text.size() == 5)
 	{
-		const auto movablePieceNumber
-		{ 
-			std::count_if(kingList.begin(), kingList.end(), [&](const std::unique_ptr<Piece>& piece)
-				{ 
-					return !piece->getMoves(*this).empty(); 
-				})
-		};
+		const std::string_view promotionLetters{ "nbrq" };
 
-		return movablePieceNumber == 0;
+		if (promotionLetters.find(text[4]) == std::string_view::npos)
+			return std::nullopt;
+
+		promotionType = Piece::getType(text[4]);
 	}
 
-	return false;
+	return createMove(toCoordinates(from.value()), toCoordinates(to.value()), promotionType);
 }
 
-bool Board::isStalemate(Piece::Color colorToPlay)
+void Board::makeMove(Move move)
 {
-	if (isKingChecked(colorToPlay))
-		return false;
+	ALLOC_SCOPE("Board::makeMove");
 
-	for (const auto& piece : getListFromColor(colorToPlay))
-		for (const auto& move : piece->getMoves(*this))
-			return false;
+	const bool isIrreversible{ move.isCapture() || Piece::getType(m_matrix(toCoordinates(move.getFrom()))) == Piece::Type::Pawn };
 
-	return true;
-}
+	m_keyHistory.push_back(m_positionKey);
+	m_halfmoveClock = isIrreversible ? 0 : m_halfmoveClock + 1;
 
-void Board::makeAIMove()
-{
-	constexpr int defaultDeepness{ 1 };
-	const EvaluatedMove bestMove { getBestMoveForColor(!m_playerColor, defaultDeepness) };
-	makeMove(bestMove.initialCoordinates, bestMove.move);
+	saveAccumulator(move);
+	movePiece(move);
+
+	m_colorToMove = !m_colorToMove;
+	m_positionKey ^= Zobrist::tables.blackToMove;
+	m_legalMoves = std::nullopt;
 }
 
-Board::EvaluatedMove& Board::max(EvaluatedMove& firstMove, EvaluatedMove& secondMove)
+void Board::makeMove(const Coordinates& oldCoordinates, const Coordinates& newCoordinates)
 {
-	return (firstMove.eval > secondMove.eval) ? firstMove : secondMove;
+	makeMove(createMove(oldCoordinates, newCoordinates));
 }
 
-Board::EvaluatedMove Board::getBestMoveForColor(Piece::Color color, int deepness)
+void Board::movePiece(Move move)
 {
-	EvaluatedMove bestBranchMove{};
-
-	auto& thisColorList{ getListFromColor(color) };
-	auto& rivalColorList{ getListFromColor(!color) };
+	const int oldSquareIndex{ move.getFrom() };
+	const int newSquareIndex{ move.getTo() };
+	const Coordinates oldCoordinates{ toCoordinates(oldSquareIndex) };
+	const Coordinates newCoordinates{ toCoordinates(newSquareIndex) };
 
-	constexpr auto isCastling{ [](Coordinates king, Coordinates move) { return abs(king.y - move.y) > 1; } };
-	constexpr auto getPromotionRank{ [](Piece::Color player, Piece::Color promotion) { return player == promotion ? 0 : Constants::squaresPerLine - 1; } };
+	char& newSquare{ m_matrix(newCoordinates) };
+	const auto& piece = getPieceFromList(oldCoordinates);
+	constexpr auto canCastle{ [](const Piece* piece) { return !piece->hasMoved() && (piece->getType() == Piece::Type::King || piece->getType() == Piece::Type::Rook); } };
 
-	for (auto& piece : PiecesSavestate(thisColorList).load())
+	if (move.isEnPassant())
+	{
+		//the captured pawn stands beside the capturing one, on the file it moves to
+		const int rivalPawnSquare{ oldSquareIndex - oldSquareIndex % Constants::squaresPerLine + newSquareIndex % Constants::squaresPerLine };
+		const Coordinates rivalPawnCoordinates{ toCoordinates(rivalPawnSquare) };
+
+		m_positionKey ^= Zobrist::getPieceKey(m_matrix(rivalPawnCoordinates), rivalPawnSquare);
+		m_pawnKey ^= Zobrist::getPieceKey(m_matrix(rivalPawnCoordinates), rivalPawnSquare);
+		m_materialSignature -= getMaterialUnit(m_matrix(rivalPawnCoordinates));
+		updateAccumulator(m_matrix(rivalPawnCoordinates), rivalPawnCoordinates, false);
+		erasePieceFromList(rivalPawnCoordinates);
+		m_matrix(rivalPawnCoordinates) = 'x';
+	}
+	else if (move.isCapture())
 	{
-		EvaluatedMove bestMove{};
+		const Piece* capturedPiece{ getPieceFromList(newCoordinates) };
 
-		for (const auto& move : piece->getMoves(*this) )
-		{
-			PiecesSavestate initialPieceState{ thisColorList };
-			PiecesSavestate initialRivalPieceState{ rivalColorList };
-			EnPassantSavestate initialEnPassantState{ m_enPassant };
+		m_positionKey ^= Zobrist::getPieceKey(newSquare, newSquareIndex);
+		updateAccumulator(newSquare, newCoordinates, false);
 
-			Coordinates initialCoordinates{ piece->getCoordinates() };
-			char& initialPosition{ m_matrix(initialCoordinates) };
-			char& attackedPosition{ m_matrix(move) };
-			const char initialLetter{ m_matrix(initialCoordinates) };
-			const char attackedLetter{ m_matrix(move) };
+		if (capturedPiece->getType() == Piece::Type::Pawn)
+			m_pawnKey ^= Zobrist::getPieceKey(newSquare, newSquareIndex);
 
-			std::optional<BoardMatrix> currentMatrix{};
-			
-			if	(
-					(isEnPassant(move, piece->getColor()) && piece->getType() == Piece::Type::Pawn) || 
-					(piece->getType() == Piece::Type::King && isCastling(initialCoordinates, move)) ||
-					(piece->getType() == Piece::Type::Pawn && getPromotionRank(m_playerColor, piece->getColor()) == move.x)
-				)
-			{
-				currentMatrix = m_matrix;
-			}
+		if (canCastle(capturedPiece))
+			m_positionKey ^= Zobrist::tables.unmoved[static_cast<size_t>(newSquareIndex)];
 
-			makeMove(initialCoordinates, move);
-			
-			EvaluatedMove thisMove{ initialCoordinates, move };
-			thisMove.eval = (deepness > 0) ? -getBestMoveForColor(!color, deepness - 1).eval : getColorEval(color);
-			
-			bestMove = max(bestMove, thisMove);
-			
-			if (currentMatrix)
-			{
-				m_matrix = currentMatrix.value();
-			}
-			else
-			{
-				initialPosition = initialLetter;
-				attackedPosition = attackedLetter;
-			}
-			
-			thisColorList = initialPieceState.load();
-			rivalColorList = initialRivalPieceState.load();
-			m_enPassant = initialEnPassantState.load();
-		}
-		
-		bestBranchMove = max(bestBranchMove, bestMove);
+		m_materialSignature -= getMaterialUnit(newSquare);
+		erasePieceFromList(newCoordinates);
 	}
 
-	return bestBranchMove;
-}
+	if (m_enPassant)
+		m_positionKey ^= Zobrist::tables.enPassant[static_cast<size_t>(toSquare(m_enPassant->coordinates))];
 
-int Board::getColorEval(Piece::Color color)
-{
-	if (isKingMated(color))
-		return Constants::minEval;
+	m_enPassant = std::nullopt;
 
-	if (isKingMated(!color))
-		return Constants::maxEval;
+	if (!piece->hasMoved())
+	{
+		if (canCastle(piece))
+			m_positionKey ^= Zobrist::tables.unmoved[static_cast<size_t>(oldSquareIndex)];
 
-	const auto& thisColorList{ getListFromColor(color) };
-	const auto& rivalColorList{ getListFromColor(!color) };
-	int eval{ 0 };
+		piece->addMovedFlag();
+	}
 
-	for (const auto& piece : thisColorList)
+	//only a double push leaves a square behind to be captured en passant
+	if (move.getFlag() == Move::Flag::DoublePawnPush)
 	{
-		eval += piece->getValue() * 100;
-
-		for (int i{0}; i < piece->getAttacks(*this).size(); ++i)
-			eval += 5;
+		m_enPassant = EnPassant{ toCoordinates((oldSquareIndex + newSquareIndex) / 2), !piece->getColor() };
+		m_positionKey ^= Zobrist::tables.enPassant[static_cast<size_t>(toSquare(m_enPassant->coordinates))];
 	}
 
-	for (const auto& piece : rivalColorList)
-		eval -= piece->getValue() * 100;
+	const char letter{ m_matrix(oldCoordinates) };
+	m_positionKey ^= Zobrist::getPieceKey(letter, oldSquareIndex) ^ Zobrist::getPieceKey(letter, newSquareIndex);
+	updateAccumulator(letter, oldCoordinates, false);
+	updateAccumulator(letter, newCoordinates, true);
+
+	if (piece->getType() == Piece::Type::Pawn)
+		m_pawnKey ^= Zobrist::getPieceKey(letter, oldSquareIndex) ^ Zobrist::getPieceKey(letter, newSquareIndex);
+
+	piece->getCoordinates() = newCoordinates;
+	newSquare = letter;
+	m_matrix(oldCoordinates) = 'x';
+	m_pieceHandles[static_cast<size_t>(newSquareIndex)] = m_pieceHandles[static_cast<size_t>(oldSquareIndex)];
+
+	if (piece->getType() == Piece::Type::King)
+		m_kingSquares[static_cast<size_t>(piece->getColor())] = newSquareIndex;
 
-	return eval;
+	if (move.isPromotion())
+	{
+		const char promotionLetter{ Piece::getLetter(move.getPromotionType(), piece->getColor()) };
+		m_positionKey ^= Zobrist::getPieceKey(letter, newSquareIndex) ^ Zobrist::getPieceKey(promotionLetter, newSquareIndex);
+		m_pawnKey ^= Zobrist::getPieceKey(letter, newSquareIndex);
+		m_materialSignature += getMaterialUnit(promotionLetter) - getMaterialUnit(letter);
+		updateAccumulator(letter, newCoordinates, false);
+		updateAccumulator(promotionLetter, newCoordinates, true);
+		//the pawn's slot was just freed, so there's always room
+		erasePieceFromList(newCoordinates);
+		addPieceToList(promotionLetter, newCoordinates, true);
+		newSquare = promotionLetter;
+	}
+	
+	if (move.isCastling())
+	{
+		//the rook jumps from its corner to the square the king passed over
+		const int rank{ oldSquareIndex / Constants::squaresPerLine * Constants::squaresPerLine };
+		const bool isKingSide{ move.getFlag() == Move::Flag::KingCastle };
+		movePiece(Move{ rank + (isKingSide ? Constants::squaresPerLine - 1 : 0), (oldSquareIndex + newSquareIndex) / 2 });
+	}
 }
 
-Board::PiecesSavestate::PiecesSavestate(const std::vector<std::unique_ptr<Piece>>& piecesList)
+const std::vector<Move>& Board::getLegalMoves()
 {
-	save(piecesList);
+	return getLegalMoveState().moves;
 }
 
-void Board::PiecesSavestate::save(const std::vector<std::unique_ptr<Piece>>& piecesList)
+std::vector<Coordinates> Board::getMoves(const Coordinates& coordinates)
 {
-	m_pieces.reserve(piecesList.size());
-	
-	for (const auto& piece : piecesList)
-		m_pieces.push_back(Piece::toPiece(piece->getLetter(), piece->getCoordinates(), piece->hasMoved()));
+	if (Piece::getColor(m_matrix(coordinates)) != m_colorToMove)
+		return getPieceFromList(coordinates)->getMoves(*this);
+
+	const int from{ toSquare(coordinates) };
+	std::vector<Coordinates> moves{};
+
+	for (const Move move : getLegalMoves())
+		if (move.getFrom() == from)
+			moves.push_back(toCoordinates(move.getTo()));
+
+	return moves;
+}
+
+bool Board::isValidMove(const Coordinates& oldCoordinates, const Coordinates& newCoordinates)
+{
+	const int from{ toSquare(oldCoordinates) };
+	const int to{ toSquare(newCoordinates) };
+
+	const auto& moves{ getLegalMoves() };
+	return std::any_of(moves.begin(), moves.end(), [&](Move move) { return move.getFrom() == from && move.getTo() == to; });
+}
+
+Board::GameStatus Board::getGameStatus()
+{
+	return getLegalMoveState().status;
+}
+
+//only queen promotions are generated, as the search has always done
+std::vector<Move> Board::generateMoves(Piece::Color color) const
+{
+	TRACE_SCOPE("Board::generateMoves");
+
+	std::vector<Move> moves{};
+
+	for (const auto* piece : getListFromColor(color))
+	{
+		const Coordinates& coordinates{ piece->getCoordinates() };
+
+		for (const auto& move : piece->getMoves(*this))
+			moves.push_back(createMove(coordinates, move));
+	}
+
+	return moves;
+}
+
+std::vector<Move> Board::generateCaptures(Piece::Color color) const
+{
+	TRACE_SCOPE("Board::generateCaptures");
+
+	std::vector<Move> moves{};
+
+	for (const auto* piece : getListFromColor(color))
+	{
+		const Coordinates& coordinates{ piece->getCoordinates() };
+
+		for (const auto& capture : piece->getCaptures(*this))
+			moves.push_back(createMove(coordinates, capture));
+	}
+
+	return moves;
+}
+
+std::vector<Move> Board::generateQuiets(Piece::Color color) const
+{
+	TRACE_SCOPE("Board::generateQuiets");
+
+	std::vector<Move> moves{};
+
+	for (const auto* piece : getListFromColor(color))
+	{
+		const Coordinates& coordinates{ piece->getCoordinates() };
+
+		for (const auto& quiet : piece->getQuiets(*this))
+			moves.push_back(createMove(coordinates, quiet));
+	}
+
+	return moves;
+}
+
+//whether the move is one of generateMoves', asking only its own piece for its moves
+bool Board::isPlayableMove(Move move, Piece::Color color) const
+{
+	const Coordinates oldCoordinates{ toCoordinates(move.getFrom()) };
+	const Coordinates newCoordinates{ toCoordinates(move.getTo()) };
+	const char letter{ m_matrix(oldCoordinates) };
+
+	if (!Piece::isPiece(letter) || Piece::getColor(letter) != color)
+		return false;
+
+	if (createMove(oldCoordinates, newCoordinates, move.isPromotion() ? move.getPromotionType() : Piece::Type::Queen) != move)
+		return false;
+
+	const auto moves{ getPieceFromList(oldCoordinates)->getMoves(*this) };
+	return std::find(moves.begin(), moves.end(), newCoordinates) != moves.end();
+}
+
+const Board::LegalMoves& Board::getLegalMoveState()
+{
+	if (m_legalMoves && m_legalMoves->positionKey == m_positionKey)
+		return m_legalMoves.value();
+
+	//only generating them is traced, cache hits would pass for it otherwise
+	TRACE_SCOPE("Board::getLegalMoves");
+
+	LegalMoves legalMoves{ m_positionKey, generateMoves(m_colorToMove) };
+
+	if (legalMoves.moves.empty())
+		legalMoves.status = isKingChecked(m_colorToMove) ? GameStatus::Checkmate : GameStatus::Stalemate;
+	else if (isThreefoldRepetition())
+		legalMoves.status = GameStatus::ThreefoldRepetition;
+	else if (isFiftyMoveRule())
+		legalMoves.status = GameStatus::FiftyMoveRule;
+	else if (isInsufficientMaterial())
+		legalMoves.status = GameStatus::InsufficientMaterial;
+
+	m_legalMoves = std::move(legalMoves);
+
+	return m_legalMoves.value();
+}
+
+bool Board::isEnPassant(const Coordinates& coordinates, Piece::Color color) const
+{
+	return (m_enPassant) ? m_enPassant->coordinates == coordinates && m_enPassant->movingColor == color : false;
+}
+
+bool Board::isLegalMove(const Coordinates& oldCoordinates, const Coordinates& newCoordinates) const
+{
+	ALLOC_SCOPE("Board::isLegalMove");
+
+	const char letter{ m_matrix(oldCoordinates) };
+	const Piece::Color pieceColor{ Piece::getColor(letter) };
+
+	//played on a copy of the squares, so checking a move never writes to the board
+	BoardMatrix matrix{ m_matrix };
+	matrix(oldCoordinates) = 'x';
+	matrix(newCoordinates) = letter;
+
+	//an en passant capture also empties the captured pawn's square, which can uncover the king
+	if (Piece::getType(letter) == Piece::Type::Pawn && isEnPassant(newCoordinates, pieceColor))
+		matrix(newCoordinates + Coordinates{ getForwardDirection(!pieceColor), 0 }) = 'x';
+
+	const bool isKing{ Piece::getType(letter) == Piece::Type::King };
+
+	return !isAttackedBy(matrix, isKing ? newCoordinates : getKingCoordinates(pieceColor), !pieceColor);
+}
+
+bool Board::isAttacked(const Coordinates& coordinates) const
+{
+	Piece::Color color{ Piece::getColor(m_matrix(coordinates)) };
+	return isAttackedBy(coordinates, !color);
+}
+
+bool Board::isAttackedBy(const Coordinates& coordinates, Piece::Color color) const
+{
+	//a piece never attacks its own side's squares
+	const char letter{ m_matrix(coordinates) };
+
+	if (Piece::isPiece(letter) && Piece::getColor(letter) == color)
+		return false;
+
+	return isAttackedBy(m_matrix, coordinates, color);
+}
+
+//looks outwards from the square for every kind of piece that could reach it, instead of generating each piece's attacks
+bool Board::isAttackedBy(const BoardMatrix& matrix, const Coordinates& coordinates, Piece::Color color) const
+{
+	constexpr std::array<Coordinates, 4> straightDirections{ { {0, 1}, {0, -1}, {1, 0}, {-1, 0} } };
+	constexpr std::array<Coordinates, 4> diagonalDirections{ { {1, 1}, {-1, -1}, {-1, 1}, {1, -1} } };
+	constexpr std::array<Coordinates, 8> knightJumps{ { {2, 1}, {2, -1}, {1, 2}, {-1, 2}, {-2, 1}, {-2, -1}, {1, -2}, {-1, -2} } };
+
+	const char pawn{ Piece::getLetter(Piece::Type::Pawn, color) };
+	const char knight{ Piece::getLetter(Piece::Type::Knight, color) };
+	const char bishop{ Piece::getLetter(Piece::Type::Bishop, color) };
+	const char rook{ Piece::getLetter(Piece::Type::Rook, color) };
+	const char queen{ Piece::getLetter(Piece::Type::Queen, color) };
+	const char king{ Piece::getLetter(Piece::Type::King, color) };
+
+	const auto isOn{ [&](const Coordinates& square, char letter) { return !isOutOfBounds(square) && matrix(square) == letter; } };
+
+	//pawns attack diagonally forward, so they stand diagonally behind the squares they attack
+	const int pawnRow{ coordinates.x - getForwardDirection(color) };
+
+	if (isOn({ pawnRow, coordinates.y - 1 }, pawn) || isOn({ pawnRow, coordinates.y + 1 }, pawn))
+		return true;
+
+	for (const auto& jump : knightJumps)
+		if (isOn(coordinates + jump, knight))
+			return true;
+
+	for (const auto* directions : { &straightDirections, &diagonalDirections })
+		for (const auto& direction : *directions)
+			if (isOn(coordinates + direction, king))
+				return true;
+
+	const auto isSliderOn
+	{
+		[&](const std::array<Coordinates, 4>& directions, char slider)
+		{
+			for (const auto& direction : directions)
+				for (Coordinates current{ coordinates + direction }; !isOutOfBounds(current); current = current + direction)
+				{
+					const char letter{ matrix(current) };
+
+					if (letter == slider || letter == queen)
+						return true;
+
+					if (Piece::isPiece(letter))
+						break;
+				}
+
+			return false;
+		}
+	};
+
+	return isSliderOn(straightDirections, rook) || isSliderOn(diagonalDirections, bishop);
+}
+
+//false when the color's pool is already full, which only a position set up from outside can get to
+bool Board::addPieceToList(char letter, const Coordinates& coordinates, bool hasMoved)
+{
+	const Piece::Color color{ Piece::getColor(letter) };
+	const int square{ toSquare(coordinates) };
+	const auto handle{ getListFromColor(color).add(letter, coordinates, hasMoved) };
+
+	if (!handle)
+		return false;
+
+	m_pieceHandles[static_cast<size_t>(square)] = handle.value();
+
+	if (Piece::getType(letter) == Piece::Type::King)
+		m_kingSquares[static_cast<size_t>(color)] = square;
+
+	return true;
+}
+
+void Board::erasePieceFromList(const Coordinates& coordinates)
+{
+	const char letter{ m_matrix(coordinates) };
+	getListFromColor(Piece::getColor(letter)).erase(m_pieceHandles[static_cast<size_t>(toSquare(coordinates))]);
+}
+
+Piece* Board::getPieceFromList(const Coordinates& coordinates)
+{
+	return const_cast<Piece*>(std::as_const(*this).getPieceFromList(coordinates));
+}
+
+const Piece* Board::getPieceFromList(const Coordinates& coordinates) const
+{
+	const char letter{ m_matrix(coordinates) };
+	return getListFromColor(Piece::getColor(letter)).get(m_pieceHandles[static_cast<size_t>(toSquare(coordinates))]);
+}
+
+Coordinates Board::getKingCoordinates(Piece::Color color) const
+{
+	return toCoordinates(m_kingSquares[static_cast<size_t>(color)]);
+}
+
+//the king and the rook are both on their starting squares and neither has moved yet
+bool Board::hasCastlingRight(int kingSquare, int rookSquare) const
+{
+	const Piece::Color color{ (kingSquare < Constants::squaresPerLine) ? Piece::Color::White : Piece::Color::Black };
+	const auto isUnmoved
+	{
+		[&](int square, Piece::Type type)
+		{
+			const Coordinates coordinates{ toCoordinates(square) };
+			return m_matrix(coordinates) == Piece::getLetter(type, color) && !getPieceFromList(coordinates)->hasMoved();
+		}
+	};
+
+	return isUnmoved(kingSquare, Piece::Type::King) && isUnmoved(rookSquare, Piece::Type::Rook);
+}
+
+bool Board::isFromPlayer(const Coordinates& coordinates) const
+{
+	const char letter{ m_matrix(coordinates.x, coordinates.y) };
+	return Piece::isPiece(letter) && Piece::getColor(letter) == m_playerColor;
+}
+
+bool Board::isOutOfBounds(const Coordinates& coordinates)
+{
+	return coordinates < Coordinates{ 0, 0 } || coordinates > Coordinates{ Constants::squaresPerLine - 1, Constants::squaresPerLine - 1 };
+}
+
+//maps matrix coordinates to a square numbered from white's side (a1 = 0, h8 = 63), whatever the player's color
+int Board::toSquare(const Coordinates& coordinates) const
+{
+	constexpr int lastLine{ Constants::squaresPerLine - 1 };
+
+	if (m_playerColor == Piece::Color::White)
+		return (lastLine - coordinates.x) * Constants::squaresPerLine + coordinates.y;
+
+	return coordinates.x * Constants::squaresPerLine + (lastLine - coordinates.y);
+}
+
+Coordinates Board::toCoordinates(int square) const
+{
+	constexpr int lastLine{ Constants::squaresPerLine - 1 };
+	const int rank{ square / Constants::squaresPerLine };
+	const int file{ square % Constants::squaresPerLine };
+
+	if (m_playerColor == Piece::Color::White)
+		return { lastLine - rank, file };
+
+	return { rank, lastLine - file };
+}
+
+Zobrist::Key Board::computePositionKey() const
+{
+	Zobrist::Key key{ 0 };
+
+	for (const auto* list : { &m_whitePieces, &m_blackPieces })
+	{
+		for (const auto* piece : *list)
+		{
+			const int square{ toSquare(piece->getCoordinates()) };
+			key ^= Zobrist::getPieceKey(piece->getLetter(), square);
+
+			if (!piece->hasMoved() && (piece->getType() == Piece::Type::King || piece->getType() == Piece::Type::Rook))
+				key ^= Zobrist::tables.unmoved[static_cast<size_t>(square)];
+		}
+	}
+
+	if (m_enPassant)
+		key ^= Zobrist::tables.enPassant[static_cast<size_t>(toSquare(m_enPassant->coordinates))];
+
+	if (m_colorToMove == Piece::Color::Black)
+		key ^= Zobrist::tables.blackToMove;
+
+	return key;
+}
+
+Zobrist::Key Board::computePawnKey() const
+{
+	Zobrist::Key key{ 0 };
+
+	for (const auto* list : { &m_whitePieces, &m_blackPieces })
+		for (const auto* piece : *list)
+			if (piece->getType() == Piece::Type::Pawn)
+				key ^= Zobrist::getPieceKey(piece->getLetter(), toSquare(piece->getCoordinates()));
+
+	return key;
+}
+
+Pawns::Bitboards Board::getPawnBitboards() const
+{
+	Pawns::Bitboards pawns{};
+
+	for (const auto* list : { &m_whitePieces, &m_blackPieces })
+		for (const auto* piece : *list)
+			if (piece->getType() == Piece::Type::Pawn)
+				pawns[static_cast<size_t>(piece->getColor())] |= std::uint64_t{ 1 } << toSquare(piece->getCoordinates());
+
+	return pawns;
+}
+
+const PiecePool& Board::getListFromColor(Piece::Color color) const
+{
+	return (color == Piece::Color::White) ? m_whitePieces : m_blackPieces;
+}
+
+PiecePool& Board::getListFromColor(Piece::Color color)
+{
+	return (color == Piece::Color::White) ? m_whitePieces : m_blackPieces;
+}
+
+bool Board::isKingChecked(Piece::Color color) const
+{
+	return isAttacked(getKingCoordinates(color));
+}
+
+bool Board::isKingMated(Piece::Color color)
+{
+	ALLOC_SCOPE("Board::isKingMated");
+
+	if (color == m_colorToMove && m_legalMoves && m_legalMoves->positionKey == m_positionKey)
+		return m_legalMoves->status == GameStatus::Checkmate;
+
+	const auto& kingList{ getListFromColor(color) };
+
+	if (isAttacked(getKingCoordinates(color)))
+	{
+		const auto movablePieceNumber
+		{ 
+			std::count_if(kingList.begin(), kingList.end(), [&](Piece* piece)
+				{ 
+					return !piece->getMoves(*this).empty(); 
+				})
+		};
+
+		return movablePieceNumber == 0;
+	}
+
+	return false;
+}
+
+bool Board::isStalemate(Piece::Color colorToPlay)
+{
+	if (colorToPlay == m_colorToMove && m_legalMoves && m_legalMoves->positionKey == m_positionKey)
+		return m_legalMoves->status == GameStatus::Stalemate;
+
+	if (isKingChecked(colorToPlay))
+		return false;
+
+	for (const auto& piece : getListFromColor(colorToPlay))
+		for (const auto& move : piece->getMoves(*this))
+			return false;
+
+	return true;
+}
+
+//only positions since the last capture or pawn move, with the same side to move, can be repetitions
+int Board::countRepetitions() const
+{
+	const int historySize{ static_cast<int>(m_keyHistory.size()) };
+	const int firstReversiblePly{ std::max(historySize - m_halfmoveClock, 0) };
+	int repetitions{ 0 };
+
+	for (int i{ historySize - 2 }; i >= firstReversiblePly; i -= 2)
+		if (m_keyHistory[static_cast<size_t>(i)] == m_positionKey)
+			++repetitions;
+
+	return repetitions;
+}
+
+bool Board::isThreefoldRepetition() const
+{
+	return countRepetitions() >= 2;
+}
+
+bool Board::isFiftyMoveRule() const
+{
+	constexpr int fiftyMovesInPlies{ 100 };
+	return m_halfmoveClock >= fiftyMovesInPlies;
+}
+
+bool Board::isInsufficientMaterial() const
+{
+	const std::uint64_t kings{ getMaterialUnit('k') + getMaterialUnit('K') };
+	const std::uint64_t material{ m_materialSignature - kings };
+
+	return	material == 0 || 
+			material == getMaterialUnit('n') || material == getMaterialUnit('b') ||
+			material == getMaterialUnit('N') || material == getMaterialUnit('B');
+}
+
+//inside the search a single repetition is already scored as a draw, since the same line can be repeated again
+bool Board::isSearchDraw() const
+{
+	return isInsufficientMaterial() || isFiftyMoveRule() || countRepetitions() > 0;
+}
+
+//kings are not features, so moving one only invalidates its own perspective
+void Board::updateAccumulator(char letter, const Coordinates& coordinates, bool isAdded)
+{
+	if (!Nnue::isLoaded())
+		return;
+
+	if (Piece::getType(letter) == Piece::Type::King)
+	{
+		m_accumulator.isDirty[static_cast<size_t>(Piece::getColor(letter))] = true;
+		return;
+	}
+
+	m_accumulatorUndo.changes[static_cast<size_t>(m_accumulatorUndo.changeCount++)] = { letter, toSquare(coordinates), isAdded };
+
+	for (const auto perspective : { Piece::Color::White, Piece::Color::Black })
+	{
+		if (m_accumulator.isDirty[static_cast<size_t>(perspective)])
+			continue;
+
+		const int feature{ Nnue::getFeatureIndex(perspective, m_kingSquares[static_cast<size_t>(perspective)], letter, toSquare(coordinates)) };
+
+		if (isAdded)
+			Nnue::addFeature(m_accumulator, perspective, feature);
+		else
+			Nnue::removeFeature(m_accumulator, perspective, feature);
+	}
+}
+
+void Board::refreshAccumulator(Piece::Color perspective)
+{
+	const int kingSquare{ m_kingSquares[static_cast<size_t>(perspective)] };
+
+	Nnue::clear(m_accumulator, perspective);
+
+	for (const auto* list : { &m_whitePieces, &m_blackPieces })
+		for (const auto* piece : *list)
+			if (piece->getType() != Piece::Type::King)
+				Nnue::addFeature(m_accumulator, perspective, Nnue::getFeatureIndex(perspective, kingSquare, piece->getLetter(), toSquare(piece->getCoordinates())));
+}
+
+//a king move's own perspective is kept as it was, since by the time it's taken back a refresh may have overwritten it
+void Board::saveAccumulator(Move move)
+{
+	if (!Nnue::isLoaded())
+		return;
+
+	const char letter{ m_matrix(toCoordinates(move.getFrom())) };
+	const auto kingSide{ static_cast<size_t>(Piece::getColor(letter)) };
+
+	m_accumulatorUndo.isDirty = m_accumulator.isDirty;
+	m_accumulatorUndo.changeCount = 0;
+	m_accumulatorUndo.kingValues = std::nullopt;
+
+	if (Piece::getType(letter) == Piece::Type::King && !m_accumulator.isDirty[kingSide])
+	{
+		m_accumulatorUndo.kingColor = Piece::getColor(letter);
+		m_accumulatorUndo.kingValues = m_accumulator.values[kingSide];
+	}
+}
+
+//with the king squares already back to what they were before the move
+void Board::revertAccumulator(const AccumulatorUndo& undo)
+{
+	if (!Nnue::isLoaded())
+		return;
+
+	for (const auto perspective : { Piece::Color::White, Piece::Color::Black })
+	{
+		const auto side{ static_cast<size_t>(perspective) };
+
+		m_accumulator.isDirty[side] = undo.isDirty[side];
+
+		if (undo.isDirty[side])
+			continue;
+
+		if (undo.kingValues && undo.kingColor == perspective)
+		{
+			m_accumulator.values[side] = undo.kingValues.value();
+			continue;
+		}
+
+		for (int i{ undo.changeCount - 1 }; i >= 0; --i)
+		{
+			const auto& change{ undo.changes[static_cast<size_t>(i)] };
+			const int feature{ Nnue::getFeatureIndex(perspective, m_kingSquares[side], change.letter, change.square) };
+
+			if (change.isAdded)
+				Nnue::removeFeature(m_accumulator, perspective, feature);
+			else
+				Nnue::addFeature(m_accumulator, perspective, feature);
+		}
+	}
+}
+
+std::uint64_t Board::getMaterialUnit(char letter)
+{
+	constexpr int bitsPerPieceKind{ 4 };
+	return std::uint64_t{ 1 } << (Zobrist::getPieceIndex(letter) * bitsPerPieceKind);
+}
+
+void Board::makeAIMove()
+{
+	makeAIMove(SearchLimits{});
+}
+
+void Board::makeAIMove(const SearchLimits& limits)
+{
+	TRACE_SCOPE("Board::makeAIMove");
+
+	if (const auto bookMove{ getBookMove() })
+	{
+		clearSearch();
+		makeMove(bookMove.value());
+		return;
+	}
+
+	const SearchResult bestMove{ search(limits) };
+	makeMove(bestMove.move);
+}
+
+//the book's move is checked against the legal ones, two positions could share a key
+std::optional<Move> Board::getBookMove()
+{
+	if (!Book::isLoaded())
+		return std::nullopt;
+
+	const auto move{ Book::probe(m_positionKey) };
+
+	if (!move)
+		return std::nullopt;
+
+	const auto& legalMoves{ getLegalMoves() };
+
+	if (std::find(legalMoves.begin(), legalMoves.end(), move.value()) == legalMoves.end())
+		return std::nullopt;
+
+	return move;
+}
+
+//a search the learning cache holds at least as deep as this one would go, played without searching again
+std::optional<Board::SearchResult> Board::getLearnedResult(const SearchLimits& limits)
+{
+	if (!Learning::isLoaded())
+		return std::nullopt;
+
+	const Learning::Entry* entry{ Learning::find(m_positionKey) };
+
+	if (!entry || entry->deepness < limits.deepness)
+		return std::nullopt;
+
+	//like the book's, the move is checked against the legal ones
+	const Move move{ Move::fromData(entry->move) };
+	const auto& legalMoves{ getLegalMoves() };
+
+	if (std::find(legalMoves.begin(), legalMoves.end(), move) == legalMoves.end())
+		return std::nullopt;
+
+	return SearchResult{ move, entry->eval, entry->deepness };
+}
+
+//iterative deepening, so a node or time limit can stop the search and still keep the last finished iteration
+Board::SearchResult Board::search(const SearchLimits& limits)
+{
+	m_searchControl = SearchControl{ limits, std::chrono::steady_clock::now() };
+	m_searchControl.killers.resize(static_cast<size_t>(std::max(limits.deepness, 0) + 1));
+	m_searchControl.history.resize(MovePicker::historySize);
+	SEARCH_STATS(m_searchStats = SearchStats{});
+	SEARCH_STATS(const Pawns::Stats initialPawnStats{ Pawns::getStats() });
+	SEARCH_STATS(ALLOC_TRACKING(const AllocTracking::Counts initialAllocations{ AllocTracking::getCounts() }));
+
+	if (const auto learnedResult{ getLearnedResult(limits) })
+		return learnedResult.value();
+
+	//the solver gets a board of its own, and on a clock no more time than the search. Its table belongs to the
+	//searching thread, which waits for it below, so one is allocated per thread and reused by all its searches,
+	//and only by the threads that ever run the solver
+	std::atomic<bool> isMateSolverStopped{ false };
+	std::future<MateSolver::Result> mateSolver{};
+
+	if (limits.mateNodes > 0 && isTactical())
+	{
+		thread_local MateSolver::Table mateTable{};
+		mateSolver = std::async(std::launch::async, [board{ *this }, nodes{ limits.mateNodes }, &table = mateTable, &isMateSolverStopped] { return MateSolver::solve(board, nodes, table, &isMateSolverStopped); });
+	}
+
+	SearchResult result{};
+
+	//without a node or time limit the shallower iterations would be wasted work
+	const bool isLimited{ limits.nodes > 0 || limits.time.count() > 0 };
+
+	for (int deepness{ isLimited ? 0 : limits.deepness }; deepness <= limits.deepness; ++deepness)
+	{
+		SEARCH_STATS(const auto iterationStartTime{ std::chrono::steady_clock::now() });
+		SEARCH_STATS(const std::uint64_t iterationStartNodes{ m_searchControl.nodes });
+
+		TRACE_SCOPE("Board::search iteration");
+
+		m_searchControl.iterationDeepness = deepness;
+		const EvaluatedMove bestMove{ getBestMoveForColor(m_colorToMove, deepness, Constants::minEval, Constants::maxEval) };
+
+		SEARCH_STATS(m_searchStats.iterations.push_back({ deepness, m_searchControl.nodes - iterationStartNodes, std::chrono::steady_clock::now() - iterationStartTime, !m_searchControl.isAborted }));
+
+		//an unfinished iteration is only used when there's nothing else to play
+		if (m_searchControl.isAborted && result.deepness >= 0)
+			break;
+
+		result = SearchResult{ bestMove.move, bestMove.eval, m_searchControl.isAborted ? deepness - 1 : deepness };
+
+		if (m_searchControl.isAborted)
+			break;
+	}
+
+	result.nodes = m_searchControl.nodes;
+
+	//a proven mate can't be refuted, so it's played over whatever the search found
+	if (mateSolver.valid())
+	{
+		if (limits.time.count() > 0)
+			isMateSolverStopped = true;
+
+		const MateSolver::Result mate{ mateSolver.get() };
+
+		if (mate.status == MateSolver::Status::Mate && !mate.line.empty())
+			result = SearchResult{ mate.line.front(), Constants::maxEval, result.deepness, result.nodes };
+
+		SEARCH_STATS(m_searchStats.mateSolverNodes = mate.nodes);
+		SEARCH_STATS(m_searchStats.mateSolverStatus = mate.status);
+	}
+
+	if (Learning::isLoaded() && result.deepness >= Learning::minDeepness && !result.move.isEmpty())
+		m_learnedEntries.push_back({ m_positionKey, result.eval, result.move.getData(), static_cast<std::int8_t>(result.deepness) });
+
+	SEARCH_STATS(m_searchStats.time = std::chrono::steady_clock::now() - m_searchControl.startTime);
+	SEARCH_STATS(m_searchStats.pawnProbes = Pawns::getStats().probes - initialPawnStats.probes);
+	SEARCH_STATS(m_searchStats.pawnHits = Pawns::getStats().hits - initialPawnStats.hits);
+	SEARCH_STATS(ALLOC_TRACKING(m_searchStats.allocations = AllocTracking::getCounts().allocations - initialAllocations.allocations));
+	SEARCH_STATS(ALLOC_TRACKING(m_searchStats.allocatedBytes = AllocTracking::getCounts().bytes - initialAllocations.bytes));
+
+	return result;
+}
+
+//the next copies of the board don't carry the last search's tables
+void Board::clearSearch()
+{
+	m_searchControl = SearchControl{};
+	SEARCH_STATS(m_searchStats = SearchStats{});
+}
+
+const SearchStats& Board::getSearchStats() const
+{
+	return m_searchStats;
+}
+
+//every search of the game deep enough to keep, while a learning cache is loaded
+const std::vector<Learning::Entry>& Board::getLearnedEntries() const
+{
+	return m_learnedEntries;
+}
+
+//of the last search, counted even without search statistics
+std::uint64_t Board::getSearchNodes() const
+{
+	return m_searchControl.nodes;
+}
+
+void Board::countSearchNode()
+{
+	constexpr std::uint64_t nodesPerClockCheck{ 256 };
+	const SearchLimits& limits{ m_searchControl.limits };
+
+	++m_searchControl.nodes;
+
+	if (limits.nodes > 0 && m_searchControl.nodes >= limits.nodes)
+		m_searchControl.isAborted = true;
+
+	if (limits.time.count() > 0 && m_searchControl.nodes % nodesPerClockCheck == 0)
+		if (std::chrono::steady_clock::now() - m_searchControl.startTime >= limits.time)
+			m_searchControl.isAborted = true;
+}
+
+Board::EvaluatedMove& Board::max(EvaluatedMove& firstMove, EvaluatedMove& secondMove)
+{
+	//on a tie a real move wins over an empty one, so being mated in every line still returns a move
+	const bool isSecondEmpty{ secondMove.move.isEmpty() };
+	return (firstMove.eval > secondMove.eval || (firstMove.eval == secondMove.eval && isSecondEmpty)) ? firstMove : secondMove;
+}
+
+//negamax with an alpha-beta window, evals are from the color's side
+Board::EvaluatedMove Board::getBestMoveForColor(Piece::Color color, int deepness, int alpha, int beta)
+{
+	ALLOC_SCOPE("Board::getBestMoveForColor");
+
+	const int ply{ m_searchControl.iterationDeepness - deepness };
+	const int initialAlpha{ alpha };
+	Move transpositionMove{};
+
+	SEARCH_STATS(++m_searchStats.transpositionProbes);
+
+	if (const Transposition::Entry* entry{ Transposition::find(m_positionKey) })
+	{
+		SEARCH_STATS(++m_searchStats.transpositionHits);
+		transpositionMove = Move::fromData(entry->move);
+
+		//the root has to come back with a move it has checked itself
+		const bool isUsable{ ply > 0 && entry->deepness >= deepness };
+		const bool isCutoff
+		{
+			entry->bound == Transposition::Bound::Exact ||
+			(entry->bound == Transposition::Bound::Lower && entry->eval >= beta) ||
+			(entry->bound == Transposition::Bound::Upper && entry->eval <= alpha)
+		};
+
+		if (isUsable && isCutoff)
+		{
+			SEARCH_STATS(++m_searchStats.transpositionCutoffs);
+			return { transpositionMove, entry->eval };
+		}
+	}
+
+	//close to the root a position may have been searched deeper in an earlier game
+	if (ply > 0 && ply <= Learning::maxProbePly && Learning::isLoaded())
+		if (const Learning::Entry* entry{ Learning::find(m_positionKey) }; entry && entry->deepness >= deepness)
+			return { Move::fromData(entry->move), entry->eval };
+
+	EvaluatedMove bestBranchMove{};
+
+	auto& thisColorList{ getListFromColor(color) };
+	auto& rivalColorList{ getListFromColor(!color) };
+
+	MovePicker::Killers& killers{ m_searchControl.killers[static_cast<size_t>(ply)] };
+	MovePicker picker{ *this, color, transpositionMove, killers, m_searchControl.history };
+	int triedMoves{ 0 };
+
+	for (Move move{ picker.next() }; !move.isEmpty(); move = picker.next())
+	{
+		++triedMoves;
+
+		PiecesSavestate initialPieceState{ thisColorList };
+		PiecesSavestate initialRivalPieceState{ rivalColorList };
+		EnPassantSavestate initialEnPassantState{ m_enPassant };
+		const Zobrist::Key initialPositionKey{ m_positionKey };
+		const Zobrist::Key initialPawnKey{ m_pawnKey };
+		const Piece::Color initialColorToMove{ m_colorToMove };
+		const int initialHalfmoveClock{ m_halfmoveClock };
+		const std::uint64_t initialMaterialSignature{ m_materialSignature };
+		const auto initialPieceHandles{ m_pieceHandles };
+		const auto initialKingSquares{ m_kingSquares };
+
+		char& initialPosition{ m_matrix(toCoordinates(move.getFrom())) };
+		char& attackedPosition{ m_matrix(toCoordinates(move.getTo())) };
+		const char initialLetter{ initialPosition };
+		const char attackedLetter{ attackedPosition };
+
+		std::optional<BoardMatrix> currentMatrix{};
+
+		//these touch more than the two squares
+		if (move.isEnPassant() || move.isCastling() || move.isPromotion())
+			currentMatrix = m_matrix;
+
+		makeMove(move);
+		countSearchNode();
+
+		const AccumulatorUndo accumulatorUndo{ m_accumulatorUndo };
+
+		SEARCH_STATS(const auto childPly{ static_cast<size_t>(std::min(ply + 1, SearchStats::maxPlies - 1)) });
+		SEARCH_STATS(++m_searchStats.nodesPerPly[childPly]);
+		
+		EvaluatedMove thisMove{ move };
+		const bool isDraw{ isSearchDraw() };
+
+		if (isDraw)
+			thisMove.eval = 0;
+		else if (const auto kpkEval{ getKpkEval(color) })
+			thisMove.eval = kpkEval.value();
+		else
+			thisMove.eval = (deepness > 0) ? -getBestMoveForColor(!color, deepness - 1, -beta, -alpha).eval : getColorEval(color);
+
+		SEARCH_STATS(m_searchStats.leavesPerPly[childPly] += (isDraw || deepness == 0));
+		
+		bestBranchMove = max(bestBranchMove, thisMove);
+		
+		if (currentMatrix)
+		{
+			m_matrix = currentMatrix.value();
+		}
+		else
+		{
+			initialPosition = initialLetter;
+			attackedPosition = attackedLetter;
+		}
+		
+		thisColorList = initialPieceState.load();
+		rivalColorList = initialRivalPieceState.load();
+		m_enPassant = initialEnPassantState.load();
+		m_positionKey = initialPositionKey;
+		m_pawnKey = initialPawnKey;
+		m_colorToMove = initialColorToMove;
+		m_halfmoveClock = initialHalfmoveClock;
+		m_materialSignature = initialMaterialSignature;
+		m_pieceHandles = initialPieceHandles;
+		m_kingSquares = initialKingSquares;
+		m_keyHistory.pop_back();
+		revertAccumulator(accumulatorUndo);
+
+		if (m_searchControl.isAborted)
+			break;
+
+		alpha = std::max(alpha, bestBranchMove.eval);
+
+		if (alpha < beta)
+			continue;
+
+		SEARCH_STATS(++m_searchStats.cutoffs);
+		SEARCH_STATS(m_searchStats.firstMoveCutoffs += (triedMoves == 1));
+
+		//a quiet move good enough to cut off here is likely to do so in the sibling positions too
+		if (!move.isCapture())
+		{
+			if (killers[0] != move)
+				killers = { move, killers[0] };
+
+			m_searchControl.history[MovePicker::getHistoryIndex(color, move)] += (deepness + 1) * (deepness + 1);
+		}
+
+		break;
+	}
+
+	//no legal moves and not in check means stalemate, which is a draw rather than a loss
+	if (bestBranchMove.eval == Constants::minEval && bestBranchMove.move.isEmpty() && !isKingChecked(color))
+		bestBranchMove.eval = 0;
+
+	//an unfinished node's eval only covers the moves it got to
+	if (!m_searchControl.isAborted)
+	{
+		Transposition::Bound bound{ Transposition::Bound::Exact };
+
+		if (bestBranchMove.eval <= initialAlpha)
+			bound = Transposition::Bound::Upper;
+		else if (bestBranchMove.eval >= beta)
+			bound = Transposition::Bound::Lower;
+
+		Transposition::store(m_positionKey, bestBranchMove.move, bestBranchMove.eval, deepness, bound);
+	}
+
+	return bestBranchMove;
+}
+
+int Board::getColorEval(Piece::Color color)
+{
+	TRACE_SCOPE("Board::getColorEval");
+	ALLOC_SCOPE("Board::getColorEval");
+
+	if (isKingMated(color))
+		return Constants::minEval;
+
+	if (isKingMated(!color))
+		return Constants::maxEval;
+
+	if (const auto kpkEval{ getKpkEval(color) })
+		return kpkEval.value();
+
+	if (Nnue::isLoaded())
+	{
+		for (const auto perspective : { Piece::Color::White, Piece::Color::Black })
+			if (m_accumulator.isDirty[static_cast<size_t>(perspective)])
+				refreshAccumulator(perspective);
+
+		return Nnue::evaluate(m_accumulator, color);
+	}
+
+	const auto& thisColorList{ getListFromColor(color) };
+	const auto& rivalColorList{ getListFromColor(!color) };
+	int eval{ 0 };
+
+	for (const auto& piece : thisColorList)
+		eval += piece->getValue();
+
+	for (const auto& piece : rivalColorList)
+		eval -= piece->getValue();
+
+	return eval + getMobility(color) * EvalParams::mobilityBonus + getPawnEval(color);
+}
+
+//number of squares attacked by each piece, added up
+int Board::getMobility(Piece::Color color) const
+{
+	ALLOC_SCOPE("Board::getMobility");
+
+	int mobility{ 0 };
+
+	for (const auto& piece : getListFromColor(color))
+		mobility += static_cast<int>(piece->getAttacks(*this).size());
+
+	return mobility;
+}
+
+//doubled, isolated, backward and passed pawns and the kings' pawn shields, looked up by the pawn key first
+int Board::getPawnEval(Piece::Color color) const
+{
+	ALLOC_FORBID("Board::getPawnEval");
+
+	const Pawns::Entry* entry{ Pawns::find(m_pawnKey) };
+
+	if (!entry)
+		entry = &Pawns::store(m_pawnKey, getPawnBitboards());
+
+	const int eval{ Pawns::getEval(*entry, m_kingSquares) };
+	return (color == Piece::Color::White) ? eval : -eval;
+}
+
+//the rival king already attacked around and left with few squares to go to, where a forced mate is worth looking for
+bool Board::isTactical() const
+{
+	constexpr int maxFlightSquares{ 3 };
+
+	const Coordinates kingCoordinates{ getKingCoordinates(!m_colorToMove) };
+	int attackedSquares{ 0 };
+	int flightSquares{ 0 };
+
+	for (int x{ -1 }; x <= 1; ++x)
+	{
+		for (int y{ -1 }; y <= 1; ++y)
+		{
+			const Coordinates coordinates{ kingCoordinates + Coordinates{ x, y } };
+
+			if ((x == 0 && y == 0) || isOutOfBounds(coordinates))
+				continue;
+
+			//the one looking from the square itself, so defended pieces on it count as attacked
+			const bool isAttacked{ isAttackedBy(m_matrix, coordinates, m_colorToMove) };
+			const char letter{ m_matrix(coordinates) };
+
+			attackedSquares += isAttacked;
+			flightSquares += !isAttacked && (!Piece::isPiece(letter) || Piece::getColor(letter) == m_colorToMove);
+		}
+	}
+
+	return attackedSquares > 0 && flightSquares <= maxFlightSquares;
+}
+
+//king and pawn against king is looked up rather than evaluated, the bitbase knows the outcome
+
+std::optional<int> Board::getKpkEval(Piece::Color color) const
+{
+	const std::uint64_t kings{ getMaterialUnit('k') + getMaterialUnit('K') };
+
+	for (const auto pawnColor : { Piece::Color::White, Piece::Color::Black })
+	{
+		if (m_materialSignature != kings + getMaterialUnit(Piece::getLetter(Piece::Type::Pawn, pawnColor)))
+			continue;
+
+		for (const auto* piece : getListFromColor(pawnColor))
+			if (piece->getType() == Piece::Type::Pawn)
+				return Kpk::evaluate(color, pawnColor, toSquare(piece->getCoordinates()), m_kingSquares, m_colorToMove);
+	}
+
+	return std::nullopt;
+}
+
+Board::PiecesSavestate::PiecesSavestate(const PiecePool& piecesList)
+{
+	save(piecesList);
+}
+
+void Board::PiecesSavestate::save(const PiecePool& piecesList)
+{
+	ALLOC_SCOPE("Board::PiecesSavestate");
+
+	m_pieces = piecesList;
 }
 
-std::vector<std::unique_ptr<Piece>> Board::PiecesSavestate::load()
+const PiecePool& Board::PiecesSavestate::load() const
 {
-	return std::move(m_pieces);
+	return m_pieces;
 }
 
 Board::EnPassantSavestate::EnPassantSavestate(std::optional<Board::EnPassant> enPassant)
@@ -3,23 +3,78 @@
 #include "piece.h"
 #include "coordinates.h"
 #include "constants.h"
+#include "zobrist.h"
+#include "nnue.h"
+#include "searchStats.h"
+#include "piecePool.h"
+#include "move.h"
+#include "packedPosition.h"
+#include "pawns.h"
+#include "movePicker.h"
+#include "learning.h"
 #include <vector>
+#include <array>
 #include <memory>
 #include <optional>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <chrono>
 
 class Board
 {
 	public:
 
+		enum class GameStatus
+		{
+			Ongoing,
+			Checkmate,
+			Stalemate,
+			ThreefoldRepetition,
+			FiftyMoveRule,
+			InsufficientMaterial,
+		};
+
+		struct SearchLimits
+		{
+			int deepness{ 1 };								//plies searched after each of the AI's moves
+			std::uint64_t nodes{ 0 };						//0 means no limit
+			std::chrono::milliseconds time{ 0 };			//0 means no limit
+			std::uint64_t mateNodes{ 0 };					//of the mate solver run alongside on tactical positions, 0 for none
+		};
+
+		struct SearchResult
+		{
+			Move move{};
+			int eval{ Constants::minEval };
+			int deepness{ -1 };								//deepest fully searched iteration
+			std::uint64_t nodes{ 0 };
+		};
+
 		Board(Piece::Color player);
 
+		static std::optional<Board> fromFen(std::string_view fen, Piece::Color player);
+		std::string getFen() const;
+		static std::optional<Board> fromPacked(const PackedPosition& position, Piece::Color player);
+		PackedPosition pack() const;
+
 		char operator()(const Coordinates& coordinates) const;
 
 		std::vector<const Piece*> getPieces();
 		Piece::Color getPlayerColor() const;
-
+		int getForwardDirection(Piece::Color color) const;
+		Piece::Color getColorToMove() const;
+		Zobrist::Key getPositionKey() const;
+		int getFullmoveNumber() const;
+
+		Move createMove(const Coordinates& oldCoordinates, const Coordinates& newCoordinates, Piece::Type promotionType = Piece::Type::Queen) const;
+		std::optional<Move> parseMove(std::string_view text) const;
+		void makeMove(Move move);
 		void makeMove(const Coordinates& oldCoordinates, const Coordinates& newCoordinates);
+		const std::vector<Move>& getLegalMoves();
 		std::vector<Coordinates> getMoves(const Coordinates& coordinates);
+		bool isValidMove(const Coordinates& oldCoordinates, const Coordinates& newCoordinates);
+		GameStatus getGameStatus();
 
 		bool isEnPassant(const Coordinates& coordinates, Piece::Color color) const;
 
@@ -31,22 +86,39 @@ class Board
 		bool isKingMated(Piece::Color color);
 		bool isKingChecked(Piece::Color color) const;
 		bool isStalemate(Piece::Color colorToPlay);
+		bool isThreefoldRepetition() const;
+		bool isFiftyMoveRule() const;
+		bool isInsufficientMaterial() const;
+		bool isSearchDraw() const;
 
 		void makeAIMove();
+		void makeAIMove(const SearchLimits& limits);
+		std::optional<Move> getBookMove();
+		std::optional<SearchResult> getLearnedResult(const SearchLimits& limits);
+		SearchResult search(const SearchLimits& limits);
+		void clearSearch();
+		const SearchStats& getSearchStats() const;
+		std::uint64_t getSearchNodes() const;
+		const std::vector<Learning::Entry>& getLearnedEntries() const;
 		int getColorEval(Piece::Color color);
+		int getMobility(Piece::Color color) const;
+		int getPawnEval(Piece::Color color) const;
 		
+		int toSquare(const Coordinates& coordinates) const;
+		Coordinates toCoordinates(int square) const;
+
 		static bool isOutOfBounds(const Coordinates& coordinates);
 
 		friend class Piece;
 		friend class King;
+		friend class MovePicker;
 
 	private:
 
 		struct EvaluatedMove 
 		{
-			Coordinates initialCoordinates{ -1, -1 };	//starts with impossible coordinates
-			Coordinates move{ -1, -1 };					//starts with impossible coordinates
-			int eval{ Constants::minEval };				//and min eval
+			Move move{};						//starts empty
+			int eval{ Constants::minEval };		//and with min eval
 		};
 
 		struct EnPassant
@@ -55,14 +127,41 @@ class Board
 			Piece::Color movingColor{};
 		};
 
+		//legal moves and status of the side to move, computed once per ply
+		struct LegalMoves
+		{
+			Zobrist::Key positionKey{};
+			std::vector<Move> moves{};
+			GameStatus status{ GameStatus::Ongoing };
+		};
+
+		//what a move did to the accumulator, so the search can take it back instead of copying the whole of it
+		struct AccumulatorUndo
+		{
+			struct Change
+			{
+				char letter{};
+				int square{};
+				bool isAdded{};
+			};
+
+			static constexpr int maxChanges{ 5 };		//a promotion that captures
+
+			std::array<bool, 2> isDirty{};
+			std::array<Change, maxChanges> changes{};
+			int changeCount{ 0 };
+			Piece::Color kingColor{};
+			std::optional<std::array<std::int16_t, Nnue::accumulatorSize>> kingValues{};	//a king move's own perspective, refreshed later instead of updated
+		};
+
 		class PiecesSavestate 
 		{
 			public:
-				PiecesSavestate(const std::vector<std::unique_ptr<Piece>>& piecesList);
-				void save(const std::vector<std::unique_ptr<Piece>>& piecesList);
-				std::vector<std::unique_ptr<Piece>> load();
+				PiecesSavestate(const PiecePool& piecesList);
+				void save(const PiecePool& piecesList);
+				const PiecePool& load() const;
 			private:
-				std::vector<std::unique_ptr<Piece>> m_pieces{};
+				PiecePool m_pieces{};
 		};
 
 		class EnPassantSavestate
@@ -76,17 +175,71 @@ class Board
 		};
 
 		Piece::Color m_playerColor{};
-		mutable BoardMatrix m_matrix{ {} };
+		Piece::Color m_colorToMove{ Piece::Color::White };
+		BoardMatrix m_matrix{ {} };
 		std::optional<EnPassant> m_enPassant{};
+		Zobrist::Key m_positionKey{};
+		Zobrist::Key m_pawnKey{};					//of the pawns alone, for the pawn structure table
+		std::optional<LegalMoves> m_legalMoves{};
+
+		std::vector<Zobrist::Key> m_keyHistory{};	//keys of every previous position of the game
+		int m_halfmoveClock{ 0 };					//plies since the last capture or pawn move
+		std::uint64_t m_materialSignature{ 0 };		//4 bits per piece kind, each holding how many of them are left
+
+		Nnue::Accumulator m_accumulator{};
+		AccumulatorUndo m_accumulatorUndo{};				//of the last move made
+		std::vector<Learning::Entry> m_learnedEntries{};	//the game's searches, for the learning cache
+
+		struct SearchControl
+		{
+			SearchLimits limits{};
+			std::chrono::steady_clock::time_point startTime{};
+			std::uint64_t nodes{ 0 };
+			bool isAborted{ false };
+			int iterationDeepness{ 0 };
+			std::vector<MovePicker::Killers> killers{};		//by distance from the root
+			MovePicker::History history{};
+		};
+
+		SearchControl m_searchControl{};
+		SearchStats m_searchStats{};
+
+		PiecePool m_whitePieces{};
+		PiecePool m_blackPieces{};
 
-		std::vector<std::unique_ptr<Piece>> m_whitePieces{};
-		std::vector<std::unique_ptr<Piece>> m_blackPieces{};
+		std::array<PiecePool::Handle, Constants::array2dSize> m_pieceHandles{};	//pool handle of the piece on each square, stale on empty ones
+		std::array<int, 2> m_kingSquares{};										//by color
 
-		const std::vector<std::unique_ptr<Piece>>& getListFromColor(Piece::Color color) const;
-		std::vector<std::unique_ptr<Piece>>& getListFromColor(Piece::Color color);
+		const PiecePool& getListFromColor(Piece::Color color) const;
+		PiecePool& getListFromColor(Piece::Color color);
+		bool addPieceToList(char letter, const Coordinates& coordinates, bool hasMoved);
 		void erasePieceFromList(const Coordinates& coordinates);
 		Piece* getPieceFromList(const Coordinates& coordinates);
+		const Piece* getPieceFromList(const Coordinates& coordinates) const;
+		Coordinates getKingCoordinates(Piece::Color color) const;
+		bool hasCastlingRight(int kingSquare, int rookSquare) const;
+		bool isAttackedBy(const BoardMatrix& matrix, const Coordinates& coordinates, Piece::Color color) const;
+
+		void movePiece(Move move);
+		std::vector<Move> generateMoves(Piece::Color color) const;
+		std::vector<Move> generateCaptures(Piece::Color color) const;
+		std::vector<Move> generateQuiets(Piece::Color color) const;
+		bool isPlayableMove(Move move, Piece::Color color) const;
+		const LegalMoves& getLegalMoveState();
+		Zobrist::Key computePositionKey() const;
+		Zobrist::Key computePawnKey() const;
+		Pawns::Bitboards getPawnBitboards() const;
+		int countRepetitions() const;
+		void updateAccumulator(char letter, const Coordinates& coordinates, bool isAdded);
+		void refreshAccumulator(Piece::Color perspective);
+		void saveAccumulator(Move move);
+		void revertAccumulator(const AccumulatorUndo& undo);
+		bool isTactical() const;
+		std::optional<int> getKpkEval(Piece::Color color) const;
+
+		static std::uint64_t getMaterialUnit(char letter);
 
 		EvaluatedMove& max(EvaluatedMove& firstMove, EvaluatedMove& secondMove);
-		EvaluatedMove getBestMoveForColor(Piece::Color color, int deepness);
+		EvaluatedMove getBestMoveForColor(Piece::Color color, int deepness, int alpha, int beta);
+		void countSearchNode();
 };
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "book.h"
+#include "mappedFile.h"
+#include "zobrist.h"
+#include "move.h"
+#include <string_view>
+#include <span>
+#include <optional>
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+	MappedFile s_file{};
+	std::span<const Book::Entry> s_entries{};
+	bool s_isLoaded{ false };
+}
+
+bool Book::load(std::string_view path)
+{
+	MappedFile file{};
+
+	if (!file.open(path))
+		return false;
+
+	const auto data{ file.getData() };
+	std::uint64_t entryCount{};
+
+	if (data.size() < headerSize || std::memcmp(data.data(), magic.data(), magic.size()) != 0)
+		return false;
+
+	std::memcpy(&entryCount, data.data() + magic.size(), sizeof(entryCount));
+
+	//divided rather than multiplied, a made up count could overflow
+	const std::size_t entryBytes{ data.size() - headerSize };
+
+	if (entryBytes % sizeof(Entry) != 0 || entryCount != entryBytes / sizeof(Entry))
+		return false;
+
+	s_entries = { reinterpret_cast<const Entry*>(data.data() + headerSize), static_cast<std::size_t>(entryCount) };
+	s_file = std::move(file);
+	s_isLoaded = true;
+
+	return true;
+}
+
+bool Book::isLoaded()
+{
+	return s_isLoaded;
+}
+
+std::span<const Book::Entry> Book::getEntries(Zobrist::Key key)
+{
+	const auto [first, last] { std::equal_range(s_entries.begin(), s_entries.end(), Entry{ key }, [](const Entry& a, const Entry& b) { return a.key < b.key; }) };
+	return { first, last };
+}
+
+std::optional<Move> Book::probe(Zobrist::Key key)
+{
+	const auto entries{ getEntries(key) };
+	std::uint64_t total{ 0 };
+
+	for (const Entry& entry : entries)
+		total += entry.count;
+
+	if (total == 0)
+		return std::nullopt;
+
+	//every thread that probes gets its own generator, the server's workers do so at once
+	thread_local std::mt19937_64 random{ std::random_device{}() };
+	std::uint64_t pick{ std::uniform_int_distribution<std::uint64_t>{ 0, total - 1 }(random) };
+
+	for (const Entry& entry : entries)
+	{
+		if (pick < entry.count)
+			return Move::fromData(entry.move);
+
+		pick -= entry.count;
+	}
+
+	return std::nullopt;
+}
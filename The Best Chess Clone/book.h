@@ -0,0 +1,37 @@
+#pragma once
+#include "zobrist.h"
+#include "move.h"
+#include <string_view>
+#include <span>
+#include <optional>
+#include <cstdint>
+
+//optional opening book, the moves played from each position of a set of games (see the pgn_book tool)
+//
+//the file is memory-mapped and read in place. All values are little-endian:
+//	header			"BCCBOOK1", then uint64 entryCount
+//	Entry			entries[entryCount], sorted by key, and each key's moves from the most played one down
+namespace Book
+{
+	inline constexpr std::string_view magic{ "BCCBOOK1" };
+	inline constexpr std::size_t headerSize{ 16 };
+
+	struct Entry
+	{
+		Zobrist::Key key{ 0 };
+		std::uint32_t count{ 0 };		//games that played the move
+		std::uint16_t move{ 0 };		//as in Move::getData
+		std::uint8_t score{ 0 };		//percentage of the points those games gave to the side that played it
+		std::uint8_t padding{ 0 };
+	};
+
+	static_assert(sizeof(Entry) == 16);
+
+	bool load(std::string_view path);
+	bool isLoaded();
+
+	std::span<const Entry> getEntries(Zobrist::Key key);
+
+	//one of the position's moves, each as likely as it was played
+	std::optional<Move> probe(Zobrist::Key key);
+}
@@ -2,6 +2,11 @@
 #include "piece.h"
 #include "coordinates.h"
 #include "constants.h"
+#include "nnue.h"
+#include "book.h"
+#include "learning.h"
+#include "mateSolver.h"
+#include "trace.h"
 #include <SDL.h>
 #include <SDL_image.h>
 #include <unordered_map>
@@ -10,6 +15,7 @@
 #include <string_view>
 #include <string>
 #include <vector>
+#include <iostream>
 
 std::unordered_map<Chess::ErrorCode, std::string_view> Chess::m_errorMap
 {
@@ -32,6 +38,8 @@ Chess::Chess()
 
 Chess::~Chess()
 {
+	Learning::save(m_board.getLearnedEntries());
+
 	for (auto& pair : m_pieceTextureMap)
 	{
 		SDL_DestroyTexture(pair.second);
@@ -87,40 +95,41 @@ void Chess::run()
 						Coordinates newCoordinates{ event.button.x, event.button.y };
 						newCoordinates.toMatrixCoord();
 
-						auto moves{ m_board.getMoves(oldCoordinates) };
-
-						if (std::find(moves.begin(), moves.end(), newCoordinates) == moves.end())
+						if (!m_board.isValidMove(oldCoordinates, newCoordinates))
 						{
 							renderBoard();
 							continue;
 						}
 
-						if (oldCoordinates != newCoordinates)
-							m_board.makeMove(oldCoordinates, newCoordinates);
+						m_board.makeMove(oldCoordinates, newCoordinates);
 
 						renderBoard();
 
-						if (m_board.isKingMated(!m_board.getPlayerColor()))
+						const Board::GameStatus statusAfterPlayerMove{ m_board.getGameStatus() };
+
+						if (statusAfterPlayerMove == Board::GameStatus::Checkmate)
 						{
 							renderPopup(m_winTexture);
 							hasStarted = false;
 						}
-						else if (m_board.isStalemate(m_board.getPlayerColor()))
+						else if (statusAfterPlayerMove != Board::GameStatus::Ongoing)
 						{
 							renderPopup(m_drawTexture);
 							hasStarted = false;
 						}
 						else
 						{
-							m_board.makeAIMove();
+							makeAIMove();
 							renderBoard();
 
-							if (m_board.isKingMated(m_board.getPlayerColor()))
+							const Board::GameStatus statusAfterAIMove{ m_board.getGameStatus() };
+
+							if (statusAfterAIMove == Board::GameStatus::Checkmate)
 							{
 								renderPopup(m_loseTexture);
 								hasStarted = false;
 							}
-							else if (m_board.isStalemate(!m_board.getPlayerColor()))
+							else if (statusAfterAIMove != Board::GameStatus::Ongoing)
 							{
 								renderPopup(m_drawTexture);
 								hasStarted = false;
@@ -185,6 +194,8 @@ Chess::ErrorCode Chess::init()
 
 Chess::ErrorCode Chess::loadResources()
 {
+	TRACE_SCOPE("Chess::loadResources");
+
 	SDL_SetRenderDrawBlendMode(m_renderer, SDL_BLENDMODE_BLEND);
 	
 	if (!loadTexture(m_boardTexture, "res/board.bmp"))
@@ -238,11 +249,22 @@ Chess::ErrorCode Chess::loadResources()
 		}
 	}
 
+	//the network is optional, the AI falls back to the classical evaluation without it
+	Nnue::load("res/network.nnue");
+
+	//and so is the book, without it the AI searches its first moves too
+	Book::load("res/book.bin");
+
+	//the learning cache only when it's been asked for, by creating the file
+	Learning::load("res/learning.bin");
+
 	return ErrorCode::None;
 }
 
 bool Chess::loadTexture(SDL_Texture*& texturePtr, std::string_view path)
 {
+	TRACE_SCOPE("Chess::loadTexture");
+
 	SDL_Surface* temp = (path.find(".bmp") != std::string_view::npos) ? SDL_LoadBMP(path.data()) : IMG_Load(path.data());
 
 	if (!temp)
@@ -265,13 +287,29 @@ bool Chess::loadTexture(SDL_Texture*& texturePtr, std::string_view path)
 
 void Chess::restart()
 {
+	Learning::save(m_board.getLearnedEntries());
+
 	m_board = Board{ (rand() % 2 == 0) ? Piece::Color::White : Piece::Color::Black };
 	if (m_board.getPlayerColor() == Piece::Color::Black)
-		m_board.makeAIMove();
+		makeAIMove();
+}
+
+void Chess::makeAIMove()
+{
+	Board::SearchLimits limits{};
+	limits.mateNodes = MateSolver::gameNodes;
+
+	m_board.makeAIMove(limits);
+
+	//one JSON line per AI move, so slow moves can be explained from the logs
+	if constexpr (SearchStats::isEnabled())
+		std::clog << m_board.getSearchStats().toJson() << '\n';
 }
 
 void Chess::renderBoard()
 {
+	TRACE_SCOPE("Chess::renderBoard");
+
 	SDL_RenderClear(m_renderer);
 
 	SDL_Rect fullBoardRect{ 0, 0, Constants::windowSize, Constants::windowSize };
@@ -291,6 +329,8 @@ void Chess::renderBoard()
 
 void Chess::renderBoard(std::vector<Coordinates>& attacks)
 {
+	TRACE_SCOPE("Chess::renderBoard");
+
 	SDL_RenderClear(m_renderer);
 	SDL_SetRenderDrawColor(m_renderer, 0, 255, 255, 150);
 
@@ -318,6 +358,8 @@ void Chess::renderBoard(std::vector<Coordinates>& attacks)
 
 void Chess::renderPopup(SDL_Texture*& popup)
 {
+	TRACE_SCOPE("Chess::renderPopup");
+
 	SDL_RenderClear(m_renderer);
 	SDL_Rect fullBoardRect{ 0, 0, Constants::windowSize, Constants::windowSize };
 	SDL_RenderCopy(m_renderer, popup, nullptr, &fullBoardRect);
@@ -56,6 +56,7 @@ class Chess
 		ErrorCode loadResources();
 		bool loadTexture(SDL_Texture*& texturePtr, std::string_view path);
 		void restart();
+		void makeAIMove();
 		void renderBoard();
 		void renderBoard(std::vector<Coordinates>& attacks);
 		void renderPopup(SDL_Texture*& popup);
@@ -0,0 +1,765 @@
+#include "board.h"
+#include "piece.h"
+#include "move.h"
+#include "coordinates.h"
+#include "constants.h"
+#include "evaluation.h"
+#include "packedPosition.h"
+#include "bench.h"
+#include "wire.h"
+#include "perfCounters.h"
+#include "nnue.h"
+#include "transposition.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <array>
+#include <memory>
+#include <optional>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <random>
+#include <filesystem>
+#include <cstdint>
+
+//microbenchmarks of the board and piece primitives over a fixed set of positions
+//
+//usage: chess_bench [--repetitions n] [--search-repetitions n] [--warmup n] [--filter text] [--output path]
+//	or:	chess_bench bench [depth]
+//	or:	chess_bench perft [depth]
+//every repetition times one batch of calls over the whole corpus, and the report gives the
+//nanoseconds per call of those repetitions as JSON, on stdout unless an output path is given.
+//Where the hardware counters can be read, each result also has their counts per call over the timed
+//batches. The network evaluation runs on random weights, after the build's kernels are checked against plain
+//loops on them. The bench and perft commands run the end to end benchmarks instead, see bench.h
+
+namespace
+{
+	constexpr std::array<std::string_view, 8> corpus
+	{
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+		"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+		"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+		"r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+		"2r3k1/pp3ppp/4p3/3p4/3P4/2P1P3/PP3PPP/2R3K1 b - - 0 20",
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+	};
+
+	constexpr std::array<std::string_view, 6> typeNames{ "pawn", "knight", "bishop", "rook", "queen", "king" };
+	constexpr int searchDepths{ 3 };
+	constexpr int evalBatchCopies{ 64 };		//of the corpus, so the batch evaluation runs on full batches
+	constexpr int nnueCheckPlies{ 16 };			//random moves played from every corpus position while checking the network
+
+	struct Options
+	{
+		int repetitions{ 50 };
+		int searchRepetitions{ 5 };
+		int warmup{ 5 };
+		std::string filter{};
+		std::string outputPath{};
+	};
+
+	struct Result
+	{
+		std::string name{};
+		std::size_t calls{ 0 };
+		std::vector<double> nanosecondsPerCall{};
+		PerfCounters::Reading counters{};
+		std::size_t countedCalls{ 0 };		//over all the timed batches
+	};
+
+	//written out for Nnue::load, and kept to work the evaluations out without it
+	struct RandomNetwork
+	{
+		std::vector<std::int16_t> featureBiases{};
+		std::vector<std::int16_t> featureWeights{};
+		std::vector<std::int32_t> hidden1Biases{};
+		std::vector<std::int8_t> hidden1Weights{};
+		std::vector<std::int32_t> hidden2Biases{};
+		std::vector<std::int8_t> hidden2Weights{};
+		std::vector<std::int32_t> outputBias{};
+		std::vector<std::int8_t> outputWeights{};
+	};
+
+	using CoordinatesMove = std::pair<Coordinates, Coordinates>;
+
+	//folded into the report, so the compiler can't throw away the benchmarked calls
+	std::uint64_t s_checksum{ 0 };
+
+	std::optional<Options> parseOptions(int argc, char** argv)
+	{
+		Options options{};
+
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			const std::string_view argument{ argv[i] };
+
+			if (i + 1 >= argc)
+				return std::nullopt;
+
+			const char* value{ argv[++i] };
+
+			if (argument == "--repetitions")
+				options.repetitions = std::max(std::stoi(value), 1);
+			else if (argument == "--search-repetitions")
+				options.searchRepetitions = std::max(std::stoi(value), 1);
+			else if (argument == "--warmup")
+				options.warmup = std::max(std::stoi(value), 0);
+			else if (argument == "--filter")
+				options.filter = value;
+			else if (argument == "--output")
+				options.outputPath = value;
+			else
+				return std::nullopt;
+		}
+
+		return options;
+	}
+
+	Board loadPosition(std::string_view fen)
+	{
+		return Board::fromFen(fen, Piece::Color::White).value();
+	}
+
+	std::vector<Board> loadCorpus()
+	{
+		std::vector<Board> boards{};
+
+		for (const auto fen : corpus)
+			boards.push_back(loadPosition(fen));
+
+		return boards;
+	}
+
+	std::vector<const Piece*> getPieces(Board& board, Piece::Type type)
+	{
+		std::vector<const Piece*> pieces{};
+
+		for (const auto* piece : board.getPieces())
+			if (piece->getType() == type)
+				pieces.push_back(piece);
+
+		return pieces;
+	}
+
+	double getPercentile(const std::vector<double>& sorted, double percentile)
+	{
+		const auto rank{ static_cast<std::size_t>(percentile / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5) };
+		return sorted[std::min(rank, sorted.size() - 1)];
+	}
+
+	//prepare runs untimed before every batch, and batch returns how many calls it made
+	bool isSelected(const Options& options, std::string_view name)
+	{
+		return options.filter.empty() || name.find(options.filter) != std::string_view::npos;
+	}
+
+	template <typename Prepare, typename Batch>
+	void measure(std::vector<Result>& results, const Options& options, std::string name, int repetitions, Prepare prepare, Batch batch)
+	{
+		if (!isSelected(options, name))
+			return;
+
+		std::clog << name << "...\n";
+
+		Result result{ std::move(name) };
+		PerfCounters counters{};
+
+		for (int i{ 0 }; i < options.warmup + repetitions; ++i)
+		{
+			prepare();
+
+			//counted only once warmed up, but the same calls are made either way
+			if (i == options.warmup)
+				counters.reset();
+
+			const auto startTime{ std::chrono::steady_clock::now() };
+			counters.start();
+			const std::size_t calls{ batch() };
+			counters.stop();
+			const std::chrono::duration<double, std::nano> elapsed{ std::chrono::steady_clock::now() - startTime };
+
+			result.calls = calls;
+
+			if (i >= options.warmup)
+			{
+				result.nanosecondsPerCall.push_back(elapsed.count() / static_cast<double>(std::max(calls, std::size_t{ 1 })));
+				result.countedCalls += calls;
+			}
+		}
+
+		result.counters = counters.read();
+		results.push_back(std::move(result));
+	}
+
+	template <typename Batch>
+	void measure(std::vector<Result>& results, const Options& options, std::string name, Batch batch)
+	{
+		measure(results, options, std::move(name), options.repetitions, []() {}, batch);
+	}
+
+	void addPieceBenchmarks(std::vector<Result>& results, const Options& options, std::vector<Board>& boards)
+	{
+		for (std::size_t type{ 0 }; type < typeNames.size(); ++type)
+		{
+			std::vector<std::vector<const Piece*>> pieces{};
+
+			for (auto& board : boards)
+				pieces.push_back(getPieces(board, static_cast<Piece::Type>(type)));
+
+			measure(results, options, "Piece::getAttacks/" + std::string{ typeNames[type] }, [&]()
+			{
+				std::size_t calls{ 0 };
+
+				for (std::size_t i{ 0 }; i < boards.size(); ++i)
+					for (const auto* piece : pieces[i])
+					{
+						s_checksum += piece->getAttacks(boards[i]).size();
+						++calls;
+					}
+
+				return calls;
+			});
+
+			measure(results, options, "Piece::getMoves/" + std::string{ typeNames[type] }, [&]()
+			{
+				std::size_t calls{ 0 };
+
+				for (std::size_t i{ 0 }; i < boards.size(); ++i)
+					for (const auto* piece : pieces[i])
+					{
+						s_checksum += piece->getMoves(boards[i]).size();
+						++calls;
+					}
+
+				return calls;
+			});
+		}
+	}
+
+	void addBoardBenchmarks(std::vector<Result>& results, const Options& options, std::vector<Board>& boards)
+	{
+		std::vector<std::vector<CoordinatesMove>> pseudoLegalMoves{};
+
+		for (auto& board : boards)
+		{
+			auto& moves{ pseudoLegalMoves.emplace_back() };
+
+			for (std::size_t type{ 0 }; type < typeNames.size(); ++type)
+				for (const auto* piece : getPieces(board, static_cast<Piece::Type>(type)))
+					if (piece->getColor() == board.getColorToMove())
+						for (const auto& attack : piece->getAttacks(board))
+							if (!piece->isSameColorPiece(board(attack)))
+								moves.push_back({ piece->getCoordinates(), attack });
+		}
+
+		measure(results, options, "Board::isLegalMove", [&]()
+		{
+			std::size_t calls{ 0 };
+
+			for (std::size_t i{ 0 }; i < boards.size(); ++i)
+				for (const auto& [oldCoordinates, newCoordinates] : pseudoLegalMoves[i])
+				{
+					s_checksum += boards[i].isLegalMove(oldCoordinates, newCoordinates);
+					++calls;
+				}
+
+			return calls;
+		});
+
+		measure(results, options, "Board::isAttackedBy", [&]()
+		{
+			std::size_t calls{ 0 };
+
+			for (const auto& board : boards)
+				for (int square{ 0 }; square < Constants::array2dSize; ++square)
+					for (const auto color : { Piece::Color::White, Piece::Color::Black })
+					{
+						s_checksum += board.isAttackedBy(board.toCoordinates(square), color);
+						++calls;
+					}
+
+			return calls;
+		});
+
+		measure(results, options, "Board::isKingChecked", [&]()
+		{
+			std::size_t calls{ 0 };
+
+			for (const auto& board : boards)
+				for (const auto color : { Piece::Color::White, Piece::Color::Black })
+				{
+					s_checksum += board.isKingChecked(color);
+					++calls;
+				}
+
+			return calls;
+		});
+
+		measure(results, options, "Board::getColorEval", [&]()
+		{
+			std::size_t calls{ 0 };
+
+			for (auto& board : boards)
+			{
+				s_checksum += static_cast<std::uint64_t>(board.getColorEval(board.getColorToMove()));
+				++calls;
+			}
+
+			return calls;
+		});
+
+		measure(results, options, "Board::getMobility", [&]()
+		{
+			std::size_t calls{ 0 };
+
+			for (const auto& board : boards)
+			{
+				s_checksum += static_cast<std::uint64_t>(board.getMobility(board.getColorToMove()));
+				++calls;
+			}
+
+			return calls;
+		});
+
+		std::vector<PackedPosition> packedPositions{};
+
+		for (int i{ 0 }; i < evalBatchCopies; ++i)
+			for (const auto& board : boards)
+				packedPositions.push_back(board.pack());
+
+		std::vector<int> scores(packedPositions.size());
+
+		measure(results, options, "Evaluation::evaluateBatch", [&]()
+		{
+			Evaluation::evaluateBatch(packedPositions, scores);
+
+			for (const int score : scores)
+				s_checksum += static_cast<std::uint64_t>(score);
+
+			return packedPositions.size();
+		});
+
+		//there's no unmake, so every legal move gets its own fresh board before each batch
+		std::vector<Move> legalMoves{};
+		std::vector<std::string_view> legalMoveFens{};
+
+		for (std::size_t i{ 0 }; i < boards.size(); ++i)
+			for (const Move move : boards[i].getLegalMoves())
+			{
+				legalMoves.push_back(move);
+				legalMoveFens.push_back(corpus[i]);
+			}
+
+		std::vector<Board> freshBoards{};
+
+		measure(results, options, "Board::makeMove", options.repetitions, [&]()
+		{
+			freshBoards.clear();
+
+			for (const auto fen : legalMoveFens)
+				freshBoards.push_back(loadPosition(fen));
+		},
+		[&]()
+		{
+			for (std::size_t i{ 0 }; i < legalMoves.size(); ++i)
+			{
+				freshBoards[i].makeMove(legalMoves[i]);
+				s_checksum += freshBoards[i].getPositionKey();
+			}
+
+			return legalMoves.size();
+		});
+	}
+
+	//positions as text and in the wire format, both ways
+	void addEncodingBenchmarks(std::vector<Result>& results, const Options& options, std::vector<Board>& boards)
+	{
+		measure(results, options, "Board::getFen", [&]()
+		{
+			for (const auto& board : boards)
+				s_checksum += board.getFen().size();
+
+			return boards.size();
+		});
+
+		measure(results, options, "Board::fromFen", [&]()
+		{
+			for (const auto fen : corpus)
+				s_checksum += Board::fromFen(fen, Piece::Color::White)->getPositionKey();
+
+			return corpus.size();
+		});
+
+		std::vector<std::uint8_t> bytes(boards.size() * Wire::positionSize);
+
+		measure(results, options, "Wire::writePosition", [&]()
+		{
+			for (std::size_t i{ 0 }; i < boards.size(); ++i)
+				s_checksum += Wire::writePosition(boards[i], std::span{ bytes }.subspan(i * Wire::positionSize)).value();
+
+			return boards.size();
+		});
+
+		measure(results, options, "Wire::readPosition", [&]()
+		{
+			for (std::size_t i{ 0 }; i < boards.size(); ++i)
+				s_checksum += Wire::readPosition(std::span{ bytes }.subspan(i * Wire::positionSize))->toPacked().occupancy;
+
+			return boards.size();
+		});
+	}
+
+	void addSearchBenchmarks(std::vector<Result>& results, const Options& options)
+	{
+		for (int depth{ 1 }; depth <= searchDepths; ++depth)
+		{
+			std::vector<Board> freshBoards{};
+
+			measure(results, options, "Board::getBestMoveForColor/depth" + std::to_string(depth), options.searchRepetitions, [&]()
+			{
+				//every repetition starts from an empty table, as the first one does
+				freshBoards = loadCorpus();
+				Transposition::clear();
+			},
+			[&]()
+			{
+				//depth is counted in plies, the search's deepness in plies after the first one
+				const Board::SearchLimits limits{ depth - 1 };
+
+				for (auto& board : freshBoards)
+					s_checksum += board.search(limits).nodes;
+
+				return freshBoards.size();
+			});
+		}
+	}
+
+	template <typename T>
+	std::vector<T> getRandomValues(std::mt19937& random, std::size_t count, int min, int max)
+	{
+		std::uniform_int_distribution<int> distribution{ min, max };
+		std::vector<T> values(count);
+
+		for (auto& value : values)
+			value = static_cast<T>(distribution(random));
+
+		return values;
+	}
+
+	template <typename T>
+	void write(std::ostream& output, const std::vector<T>& values)
+	{
+		output.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+	}
+
+	//scaled so that about half the first layer's inputs are clamped to zero, as with a trained network
+	RandomNetwork createRandomNetwork()
+	{
+		constexpr std::size_t transformedSize{ Nnue::accumulatorSize * 2 };
+
+		std::mt19937 random{ 1 };
+		RandomNetwork network{};
+
+		network.featureBiases = getRandomValues<std::int16_t>(random, Nnue::accumulatorSize, -32, 32);
+		network.featureWeights = getRandomValues<std::int16_t>(random, std::size_t{ Nnue::inputs } * Nnue::accumulatorSize, -12, 12);
+		network.hidden1Biases = getRandomValues<std::int32_t>(random, Nnue::hiddenSize, -2000, 4000);
+		network.hidden1Weights = getRandomValues<std::int8_t>(random, Nnue::hiddenSize * transformedSize, -8, 8);
+		network.hidden2Biases = getRandomValues<std::int32_t>(random, Nnue::hiddenSize, -2000, 4000);
+		network.hidden2Weights = getRandomValues<std::int8_t>(random, Nnue::hiddenSize * Nnue::hiddenSize, -32, 32);
+		network.outputBias = getRandomValues<std::int32_t>(random, 1, -1000, 1000);
+		network.outputWeights = getRandomValues<std::int8_t>(random, Nnue::hiddenSize, -128, 127);
+
+		return network;
+	}
+
+	bool writeNetwork(const RandomNetwork& network, const std::filesystem::path& path)
+	{
+		std::ofstream output{ path, std::ios::binary };
+		const std::vector<std::uint32_t> header{ Nnue::version, Nnue::inputs, Nnue::accumulatorSize, Nnue::hiddenSize, 0, 0 };
+
+		output.write("BCCNNUE1", 8);
+		write(output, header);
+		write(output, network.featureBiases);
+		write(output, network.featureWeights);
+		write(output, network.hidden1Biases);
+		write(output, network.hidden1Weights);
+		write(output, network.hidden2Biases);
+		write(output, network.hidden2Weights);
+		write(output, network.outputBias);
+		write(output, network.outputWeights);
+
+		return static_cast<bool>(output);
+	}
+
+	int getKingSquare(Board& board, Piece::Color color)
+	{
+		for (const auto* piece : board.getPieces())
+			if (piece->getType() == Piece::Type::King && piece->getColor() == color)
+				return board.toSquare(piece->getCoordinates());
+
+		return 0;
+	}
+
+	Nnue::Accumulator getAccumulator(Board& board)
+	{
+		Nnue::Accumulator accumulator{};
+
+		for (const auto perspective : { Piece::Color::White, Piece::Color::Black })
+		{
+			const int kingSquare{ getKingSquare(board, perspective) };
+			Nnue::clear(accumulator, perspective);
+
+			for (const auto* piece : board.getPieces())
+				if (piece->getType() != Piece::Type::King)
+					Nnue::addFeature(accumulator, perspective, Nnue::getFeatureIndex(perspective, kingSquare, piece->getLetter(), board.toSquare(piece->getCoordinates())));
+		}
+
+		return accumulator;
+	}
+
+	void propagateReference(const std::uint8_t* input, std::size_t inputSize, const std::int32_t* biases, const std::int8_t* weights, std::uint8_t* output)
+	{
+		for (std::size_t row{ 0 }; row < Nnue::hiddenSize; ++row)
+		{
+			std::int32_t sum{ biases[row] };
+
+			for (std::size_t i{ 0 }; i < inputSize; ++i)
+				sum += static_cast<std::int32_t>(input[i]) * weights[row * inputSize + i];
+
+			output[row] = static_cast<std::uint8_t>(std::clamp(sum >> Nnue::weightScaleBits, 0, 127));
+		}
+	}
+
+	//the whole network with plain loops over every input, whichever kernels the build picked
+	int evaluateReference(const RandomNetwork& network, Board& board, Piece::Color sideToMove)
+	{
+		std::array<std::uint8_t, Nnue::accumulatorSize * 2> transformed{};
+		std::array<std::uint8_t, Nnue::hiddenSize> hidden1{};
+		std::array<std::uint8_t, Nnue::hiddenSize> hidden2{};
+
+		for (std::size_t half{ 0 }; half < 2; ++half)
+		{
+			const Piece::Color perspective{ half == 0 ? sideToMove : !sideToMove };
+			const int kingSquare{ getKingSquare(board, perspective) };
+			std::vector<std::int16_t> values{ network.featureBiases };
+
+			for (const auto* piece : board.getPieces())
+			{
+				if (piece->getType() == Piece::Type::King)
+					continue;
+
+				const auto feature{ static_cast<std::size_t>(Nnue::getFeatureIndex(perspective, kingSquare, piece->getLetter(), board.toSquare(piece->getCoordinates()))) };
+
+				for (std::size_t i{ 0 }; i < values.size(); ++i)
+					values[i] = static_cast<std::int16_t>(values[i] + network.featureWeights[feature * Nnue::accumulatorSize + i]);
+			}
+
+			for (std::size_t i{ 0 }; i < values.size(); ++i)
+				transformed[half * Nnue::accumulatorSize + i] = static_cast<std::uint8_t>(std::clamp<int>(values[i], 0, 127));
+		}
+
+		propagateReference(transformed.data(), transformed.size(), network.hidden1Biases.data(), network.hidden1Weights.data(), hidden1.data());
+		propagateReference(hidden1.data(), hidden1.size(), network.hidden2Biases.data(), network.hidden2Weights.data(), hidden2.data());
+
+		std::int32_t output{ network.outputBias[0] };
+
+		for (std::size_t i{ 0 }; i < hidden2.size(); ++i)
+			output += static_cast<std::int32_t>(hidden2[i]) * network.outputWeights[i];
+
+		return output / Nnue::outputScale;
+	}
+
+	//the board's evaluation of both sides against the reference, on positions a few random moves away from the corpus,
+	//and again after a search, which has to leave the accumulator just as it found it
+	bool checkNnue(const RandomNetwork& network)
+	{
+		std::mt19937 random{ 1 };
+		int mismatches{ 0 };
+
+		for (const auto fen : corpus)
+		{
+			Board board{ loadPosition(fen) };
+
+			for (int ply{ 0 }; ply < nnueCheckPlies; ++ply)
+			{
+				const std::vector<Move> moves{ board.getLegalMoves() };
+
+				if (moves.empty() || board.isInsufficientMaterial())
+					break;
+
+				for (int pass{ 0 }; pass < 2; ++pass)
+				{
+					for (const auto color : { Piece::Color::White, Piece::Color::Black })
+						mismatches += board.getColorEval(color) != evaluateReference(network, board, color);
+
+					if (pass == 0)
+						board.search(Board::SearchLimits{ 1 });
+				}
+
+				board.makeMove(moves[random() % moves.size()]);
+			}
+		}
+
+		if (mismatches > 0)
+			std::clog << mismatches << " evaluations of the network differ from the reference\n";
+
+		return mismatches == 0;
+	}
+
+	//last, as the search benchmarks would be using the network otherwise
+	bool addNnueBenchmarks(std::vector<Result>& results, const Options& options, std::vector<Board>& boards)
+	{
+		if (!isSelected(options, "Nnue::evaluate"))
+			return true;
+
+		const RandomNetwork network{ createRandomNetwork() };
+		const std::filesystem::path path{ std::filesystem::temp_directory_path() / "chess_bench.nnue" };
+
+		if (!writeNetwork(network, path) || !Nnue::load(path.string()))
+		{
+			std::clog << "Could not write and load " << path.string() << '\n';
+			return false;
+		}
+
+		if (!checkNnue(network))
+			return false;
+
+		std::vector<Nnue::Accumulator> accumulators{};
+
+		for (auto& board : boards)
+			accumulators.push_back(getAccumulator(board));
+
+		//over as many copies of the corpus as the batch evaluation, for batches long enough to time
+		measure(results, options, "Nnue::evaluate", [&]()
+		{
+			for (int copy{ 0 }; copy < evalBatchCopies; ++copy)
+				for (std::size_t i{ 0 }; i < boards.size(); ++i)
+					s_checksum += static_cast<std::uint64_t>(Nnue::evaluate(accumulators[i], boards[i].getColorToMove()));
+
+			return boards.size() * evalBatchCopies;
+		});
+
+		return true;
+	}
+
+	//left out altogether when none could be counted
+	void writeCounters(std::ostream& output, const Result& result)
+	{
+		std::string separator{};
+
+		if (const auto ipc{ result.counters.getIpc() })
+		{
+			output << ", \"counters\": {\"ipc\": " << std::setprecision(3) << ipc.value();
+			separator = ", ";
+		}
+
+		for (std::size_t i{ 0 }; i < PerfCounters::eventCount; ++i)
+		{
+			const auto event{ static_cast<PerfCounters::Event>(i) };
+			const auto perCall{ result.counters.getPer(event, result.countedCalls) };
+
+			if (!perCall)
+				continue;
+
+			output << (separator.empty() ? ", \"counters\": {" : separator) << '"' << PerfCounters::getName(event) << "_per_call\": " << std::setprecision(1) << perCall.value();
+			separator = ", ";
+		}
+
+		if (!separator.empty())
+			output << '}';
+
+		output << std::setprecision(1);
+	}
+
+	void writeJson(std::ostream& output, const std::vector<Result>& results, const Options& options)
+	{
+		output << std::fixed << std::setprecision(1)
+			<< "{\n"
+			<< "  \"positions\": " << corpus.size() << ",\n"
+			<< "  \"warmup\": " << options.warmup << ",\n"
+			<< "  \"checksum\": " << s_checksum << ",\n"
+			<< "  \"results\": [\n";
+
+		for (std::size_t i{ 0 }; i < results.size(); ++i)
+		{
+			const Result& result{ results[i] };
+			std::vector<double> sorted{ result.nanosecondsPerCall };
+			std::sort(sorted.begin(), sorted.end());
+
+			const double mean{ std::accumulate(sorted.begin(), sorted.end(), 0.0) / static_cast<double>(sorted.size()) };
+
+			output << "    {\"name\": \"" << result.name << "\""
+				<< ", \"calls\": " << result.calls
+				<< ", \"repetitions\": " << sorted.size()
+				<< ", \"ns_per_call\": {"
+				<< "\"min\": " << sorted.front()
+				<< ", \"median\": " << getPercentile(sorted, 50.0)
+				<< ", \"p90\": " << getPercentile(sorted, 90.0)
+				<< ", \"p99\": " << getPercentile(sorted, 99.0)
+				<< ", \"max\": " << sorted.back()
+				<< ", \"mean\": " << mean
+				<< "}";
+
+			writeCounters(output, result);
+			output << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+		}
+
+		output << "  ]\n}\n";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc > 1 && std::string_view{ argv[1] } == "bench")
+		return Bench::runCommand({ argv + 2, static_cast<size_t>(argc - 2) });
+
+	if (argc > 1 && std::string_view{ argv[1] } == "perft")
+		return Bench::runPerftCommand({ argv + 2, static_cast<size_t>(argc - 2) });
+
+	const auto options{ parseOptions(argc, argv) };
+
+	if (!options)
+	{
+		std::cout << "usage: chess_bench [--repetitions n] [--search-repetitions n] [--warmup n] [--filter text] [--output path]\n"
+			<< "       chess_bench bench [depth]\n"
+			<< "       chess_bench perft [depth]\n";
+		return 1;
+	}
+
+	std::vector<Board> boards{ loadCorpus() };
+	std::vector<Result> results{};
+
+	addPieceBenchmarks(results, options.value(), boards);
+	addBoardBenchmarks(results, options.value(), boards);
+	addEncodingBenchmarks(results, options.value(), boards);
+	addSearchBenchmarks(results, options.value());
+
+	if (!addNnueBenchmarks(results, options.value(), boards))
+		return 1;
+
+	if (options->outputPath.empty())
+	{
+		writeJson(std::cout, results, options.value());
+		return 0;
+	}
+
+	std::ofstream output{ options->outputPath };
+
+	if (!output)
+	{
+		std::cout << "Could not write " << options->outputPath << '\n';
+		return 1;
+	}
+
+	writeJson(output, results, options.value());
+
+	return 0;
+}
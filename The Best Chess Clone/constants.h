@@ -10,6 +10,7 @@ namespace Constants
 	inline constexpr int squareSize{ windowSize / squaresPerLine };
 	inline constexpr int array2dSize{ squaresPerLine * squaresPerLine };
 	inline constexpr int piecesPerColor{ squaresPerLine * 2 };
+	inline constexpr int expectedGamePlies{ 256 };		//just a capacity hint for per-game buffers
 	inline constexpr int maxEval{ std::numeric_limits<int>::max() / 2 }; //big number but not close enough to the limits to mess up something
 	inline constexpr int minEval{ -maxEval };							 //must be equal as maxEval * -1
 }
\ No newline at end of file
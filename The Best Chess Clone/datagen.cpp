@@ -0,0 +1,378 @@
+#include "board.h"
+#include "piece.h"
+#include "move.h"
+#include "nnue.h"
+#include "packedPosition.h"
+#include "constants.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <optional>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+//self-play training data: games from random openings at a fixed node count, every searched position kept
+//
+//usage: datagen [options]
+//	--output path		file the positions are appended to (default positions.bin)
+//	--positions n		stop once this many positions are written (default 1000000)
+//	--threads n			game threads, the writer gets its own (default: all cores)
+//	--nodes n			node limit per move (default 5000)
+//	--random-plies n	random plies before the engine takes over (default 8)
+//	--max-plies n		games longer than this are adjudicated as draws (default 300)
+//	--seed n			seed for the random openings (default 1)
+//	--net path			search with this neural network
+//
+//the file is a run of chunks, each a 16-byte header ("BCCPOS01", uint32 positionCount, uint32 zero)
+//followed by that many PackedPositions. Every position has the search's score, from white's side and
+//clamped to 16 bits, the move it chose and the game's result for white (1, 0 or -1).
+
+namespace
+{
+	constexpr std::string_view chunkMagic{ "BCCPOS01" };
+	constexpr std::size_t chunkPositions{ 8192 };
+	constexpr int maxScore{ 32000 };
+	constexpr std::chrono::seconds reportInterval{ 10 };
+
+	struct Options
+	{
+		std::string outputPath{ "positions.bin" };
+		std::uint64_t positions{ 1000000 };
+		unsigned threads{ std::max(std::thread::hardware_concurrency(), 1u) };
+		Board::SearchLimits limits{ 64, 5000 };
+		int randomPlies{ 8 };
+		int maxPlies{ 300 };
+		std::uint64_t seed{ 1 };
+		std::string networkPath{};
+	};
+
+	//a finished game's positions, linked into the writer's queue
+	struct GameRecord
+	{
+		std::atomic<GameRecord*> next{ nullptr };
+		std::vector<PackedPosition> positions{};
+	};
+
+	//intrusive multi-producer single-consumer queue (Vyukov's): a push is one exchange and one store,
+	//and game threads never wait on each other or on the writer
+	class GameQueue
+	{
+		public:
+
+			GameQueue() : m_head{ &m_stub }, m_tail{ &m_stub } {}
+
+			~GameQueue()
+			{
+				while (GameRecord* record{ pop() })
+					delete record;
+			}
+
+			void push(GameRecord* record)
+			{
+				record->next.store(nullptr, std::memory_order_relaxed);
+				GameRecord* previous{ m_head.exchange(record, std::memory_order_acq_rel) };
+				previous->next.store(record, std::memory_order_release);
+			}
+
+			//only the writer pops. Nothing comes out while a push is halfway through, the next pop gets it
+			GameRecord* pop()
+			{
+				GameRecord* tail{ m_tail };
+				GameRecord* next{ tail->next.load(std::memory_order_acquire) };
+
+				if (tail == &m_stub)
+				{
+					if (!next)
+						return nullptr;
+
+					m_tail = next;
+					tail = next;
+					next = next->next.load(std::memory_order_acquire);
+				}
+
+				if (next)
+				{
+					m_tail = next;
+					return tail;
+				}
+
+				if (tail != m_head.load(std::memory_order_acquire))
+					return nullptr;
+
+				push(&m_stub);
+				next = tail->next.load(std::memory_order_acquire);
+
+				if (!next)
+					return nullptr;
+
+				m_tail = next;
+				return tail;
+			}
+
+		private:
+
+			GameRecord m_stub{};
+			std::atomic<GameRecord*> m_head{};
+			GameRecord* m_tail{};
+	};
+
+	std::optional<Options> parseOptions(int argc, char** argv)
+	{
+		Options options{};
+
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			const std::string_view argument{ argv[i] };
+
+			if (!argument.starts_with("--") || i + 1 >= argc)
+				return std::nullopt;
+
+			const std::string_view name{ argument.substr(2) };
+			const char* value{ argv[++i] };
+
+			if (name == "output")
+				options.outputPath = value;
+			else if (name == "positions")
+				options.positions = std::stoull(value);
+			else if (name == "threads")
+				options.threads = static_cast<unsigned>(std::max(std::stoi(value), 1));
+			else if (name == "nodes")
+				options.limits.nodes = std::max(std::stoull(value), 1ull);
+			else if (name == "random-plies")
+				options.randomPlies = std::max(std::stoi(value), 0);
+			else if (name == "max-plies")
+				options.maxPlies = std::max(std::stoi(value), 1);
+			else if (name == "seed")
+				options.seed = std::stoull(value);
+			else if (name == "net")
+				options.networkPath = value;
+			else
+				return std::nullopt;
+		}
+
+		return options;
+	}
+
+	//random legal plies, drawn again until they lead to a position which is still being played
+	Board makeOpening(std::mt19937_64& random, int plies)
+	{
+		while (true)
+		{
+			Board board{ Piece::Color::White };
+
+			for (int ply{ 0 }; ply < plies && board.getGameStatus() == Board::GameStatus::Ongoing; ++ply)
+			{
+				const auto& moves{ board.getLegalMoves() };
+				board.makeMove(moves[random() % moves.size()]);
+			}
+
+			if (board.getGameStatus() == Board::GameStatus::Ongoing)
+				return board;
+		}
+	}
+
+	std::unique_ptr<GameRecord> playGame(std::mt19937_64& random, const Options& options)
+	{
+		auto record{ std::make_unique<GameRecord>() };
+		Board board{ makeOpening(random, options.randomPlies) };
+		std::int8_t whiteResult{ 0 };
+
+		record->positions.reserve(static_cast<size_t>(Constants::expectedGamePlies));
+
+		for (int ply{ 0 }; ply < options.maxPlies; ++ply)
+		{
+			const Board::GameStatus status{ board.getGameStatus() };
+
+			if (status == Board::GameStatus::Checkmate)
+			{
+				whiteResult = (board.getColorToMove() == Piece::Color::White) ? -1 : 1;
+				break;
+			}
+
+			if (status != Board::GameStatus::Ongoing)
+				break;
+
+			const Board::SearchResult result{ board.search(options.limits) };
+			const int whiteScore{ (board.getColorToMove() == Piece::Color::White) ? result.eval : -result.eval };
+
+			PackedPosition position{ board.pack() };
+			position.score = static_cast<std::int16_t>(std::clamp(whiteScore, -maxScore, maxScore));
+			position.move = result.move.getData();
+			record->positions.push_back(position);
+
+			board.makeMove(result.move);
+		}
+
+		for (auto& position : record->positions)
+			position.result = whiteResult;
+
+		return record;
+	}
+
+	//buffers positions into chunks, so the file sees a few large writes
+	class ChunkWriter
+	{
+		public:
+
+			ChunkWriter(const std::string& path) : m_output{ path, std::ios::binary | std::ios::app }
+			{
+				m_positions.reserve(chunkPositions);
+			}
+
+			~ChunkWriter()
+			{
+				flush();
+			}
+
+			bool isOpen() const
+			{
+				return static_cast<bool>(m_output);
+			}
+
+			void add(const PackedPosition& position)
+			{
+				m_positions.push_back(position);
+
+				if (m_positions.size() == chunkPositions)
+					flush();
+			}
+
+			void flush()
+			{
+				if (m_positions.empty())
+					return;
+
+				const std::uint32_t header[2]{ static_cast<std::uint32_t>(m_positions.size()), 0 };
+
+				m_output.write(chunkMagic.data(), static_cast<std::streamsize>(chunkMagic.size()));
+				m_output.write(reinterpret_cast<const char*>(header), sizeof(header));
+				m_output.write(reinterpret_cast<const char*>(m_positions.data()), static_cast<std::streamsize>(m_positions.size() * sizeof(PackedPosition)));
+				m_output.flush();
+
+				m_positions.clear();
+			}
+
+		private:
+
+			std::ofstream m_output{};
+			std::vector<PackedPosition> m_positions{};
+	};
+}
+
+int main(int argc, char** argv)
+{
+	const auto options{ parseOptions(argc, argv) };
+
+	if (!options)
+	{
+		std::cout << "usage: datagen [--output path] [--positions n] [--threads n] [--nodes n] [--random-plies n] [--max-plies n] [--seed n] [--net path]\n";
+		return 1;
+	}
+
+	if (!options->networkPath.empty() && !Nnue::load(options->networkPath))
+	{
+		std::cout << "Could not load " << options->networkPath << '\n';
+		return 1;
+	}
+
+	ChunkWriter writer{ options->outputPath };
+
+	if (!writer.isOpen())
+	{
+		std::cout << "Could not write " << options->outputPath << '\n';
+		return 1;
+	}
+
+	const auto startTime{ std::chrono::steady_clock::now() };
+
+	GameQueue queue{};
+	std::atomic<std::uint64_t> playedPositions{ 0 };
+	std::atomic<bool> isPlaying{ true };
+	std::uint64_t writtenPositions{ 0 };
+	std::uint64_t games{ 0 };
+
+	const auto report
+	{
+		[&]()
+		{
+			const double hours{ std::max(std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count(), 1e-9) / 3600.0 };
+
+			std::cout << std::fixed << std::setprecision(0)
+				<< "Positions " << writtenPositions << '/' << options->positions << "  games " << games
+				<< "  " << static_cast<double>(writtenPositions) / hours << " positions/h\n";
+		}
+	};
+
+	//the only consumer, so it owns the file and the counts it reports
+	std::thread writerThread
+	{
+		[&]()
+		{
+			auto nextReport{ std::chrono::steady_clock::now() + reportInterval };
+
+			while (true)
+			{
+				const bool wasPlaying{ isPlaying };
+				const std::unique_ptr<GameRecord> record{ queue.pop() };
+
+				if (!record)
+				{
+					if (!wasPlaying)
+						break;
+
+					std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+					continue;
+				}
+
+				for (const auto& position : record->positions)
+					writer.add(position);
+
+				writtenPositions += record->positions.size();
+				++games;
+
+				if (std::chrono::steady_clock::now() >= nextReport)
+				{
+					report();
+					nextReport += reportInterval;
+				}
+			}
+
+			writer.flush();
+		}
+	};
+
+	std::vector<std::thread> players{};
+
+	for (unsigned i{ 0 }; i < options->threads; ++i)
+	{
+		players.emplace_back([&, i]()
+		{
+			std::mt19937_64 random{ options->seed * 0x9E3779B97F4A7C15ull + i };
+
+			while (playedPositions < options->positions)
+			{
+				auto record{ playGame(random, options.value()) };
+				playedPositions += record->positions.size();
+				queue.push(record.release());
+			}
+		});
+	}
+
+	for (auto& player : players)
+		player.join();
+
+	isPlaying = false;
+	writerThread.join();
+
+	report();
+
+	return 0;
+}
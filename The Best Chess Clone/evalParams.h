@@ -0,0 +1,14 @@
+#pragma once
+#include <array>
+
+//evaluation weights in centipawns, can be regenerated by the tune tool
+namespace EvalParams
+{
+	inline constexpr std::array<int, 6> pieceValues{ 100, 300, 300, 500, 900, 0 };	//indexed by Piece::Type, the king is never traded
+	inline constexpr int mobilityBonus{ 5 };										//per attacked square
+	inline constexpr int doubledPawnPenalty{ 12 };									//per pawn behind another on its file
+	inline constexpr int isolatedPawnPenalty{ 10 };
+	inline constexpr int backwardPawnPenalty{ 8 };
+	inline constexpr std::array<int, 8> passedPawnBonus{ 0, 5, 10, 20, 35, 60, 100, 0 };	//by rank, counted from the pawn's side
+	inline constexpr std::array<int, 2> pawnShieldBonus{ 10, 5 };						//per pawn in front of the king, on its second and third ranks
+}
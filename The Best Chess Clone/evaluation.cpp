@@ -0,0 +1,291 @@
+#include "evaluation.h"
+#include "packedPosition.h"
+#include "evalParams.h"
+#include "pawns.h"
+#include "kpk.h"
+#include "piece.h"
+#include "constants.h"
+#include "allocTracking.h"
+#include <array>
+#include <algorithm>
+#include <bit>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__AVX2__)
+	#define EVALUATION_USE_AVX2
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define EVALUATION_USE_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace
+{
+	//a register of byte lanes, a position each. Masks are 0xff in the lanes they hold for
+#if defined(EVALUATION_USE_AVX2)
+	using Lanes = __m256i;
+	constexpr int laneCount{ 32 };
+
+	Lanes load(const std::uint8_t* bytes) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(bytes)); }
+	void store(std::uint8_t* bytes, Lanes lanes) { _mm256_store_si256(reinterpret_cast<__m256i*>(bytes), lanes); }
+	Lanes broadcast(std::uint8_t value) { return _mm256_set1_epi8(static_cast<char>(value)); }
+	Lanes isEqual(Lanes first, Lanes second) { return _mm256_cmpeq_epi8(first, second); }
+	Lanes bitAnd(Lanes first, Lanes second) { return _mm256_and_si256(first, second); }
+	Lanes bitOr(Lanes first, Lanes second) { return _mm256_or_si256(first, second); }
+	Lanes subtract(Lanes first, Lanes second) { return _mm256_sub_epi8(first, second); }
+	bool isNone(Lanes mask) { return _mm256_testz_si256(mask, mask) != 0; }
+#elif defined(EVALUATION_USE_SSE2)
+	using Lanes = __m128i;
+	constexpr int laneCount{ 16 };
+
+	Lanes load(const std::uint8_t* bytes) { return _mm_load_si128(reinterpret_cast<const __m128i*>(bytes)); }
+	void store(std::uint8_t* bytes, Lanes lanes) { _mm_store_si128(reinterpret_cast<__m128i*>(bytes), lanes); }
+	Lanes broadcast(std::uint8_t value) { return _mm_set1_epi8(static_cast<char>(value)); }
+	Lanes isEqual(Lanes first, Lanes second) { return _mm_cmpeq_epi8(first, second); }
+	Lanes bitAnd(Lanes first, Lanes second) { return _mm_and_si128(first, second); }
+	Lanes bitOr(Lanes first, Lanes second) { return _mm_or_si128(first, second); }
+	Lanes subtract(Lanes first, Lanes second) { return _mm_sub_epi8(first, second); }
+	bool isNone(Lanes mask) { return _mm_movemask_epi8(mask) == 0; }
+#else
+	using Lanes = std::uint8_t;
+	constexpr int laneCount{ 1 };
+
+	Lanes load(const std::uint8_t* bytes) { return *bytes; }
+	void store(std::uint8_t* bytes, Lanes lanes) { *bytes = lanes; }
+	Lanes broadcast(std::uint8_t value) { return value; }
+	Lanes isEqual(Lanes first, Lanes second) { return (first == second) ? 0xff : 0; }
+	Lanes bitAnd(Lanes first, Lanes second) { return first & second; }
+	Lanes bitOr(Lanes first, Lanes second) { return first | second; }
+	Lanes subtract(Lanes first, Lanes second) { return static_cast<Lanes>(first - second); }
+	bool isNone(Lanes mask) { return mask == 0; }
+#endif
+
+	constexpr int squares{ Constants::array2dSize };
+	constexpr int lines{ Constants::squaresPerLine };
+	constexpr int materialTypes{ 5 };		//the kings cancel out, there's always one of each
+
+	using LaneBytes = std::array<std::uint8_t, laneCount>;
+
+	//a square's piece code in every position of the batch, by square
+	//
+	//positions are turned around for black to move, so the side to move always has the low codes
+	//and its pawns always go up the board
+	struct alignas(32) Batch
+	{
+		std::array<LaneBytes, squares> codes{};
+		std::array<Pawns::Bitboards, laneCount> pawns{};			//pawn structure is scored a position at a time
+		std::array<std::array<int, 2>, laneCount> kingSquares{};
+		int size{ 0 };
+	};
+
+	struct Targets
+	{
+		std::array<std::uint8_t, 8> squares{};
+		int count{ 0 };
+	};
+
+	using Step = std::array<int, 2>;		//files and ranks
+
+	constexpr std::array<Step, 8> rayDirections{ { { 0, 1 }, { 0, -1 }, { 1, 0 }, { -1, 0 }, { 1, 1 }, { -1, -1 }, { -1, 1 }, { 1, -1 } } };
+	constexpr int straightRays{ 4 };		//the first ones, the rest are diagonal
+	constexpr std::array<Step, 8> knightSteps{ { { 2, 1 }, { 2, -1 }, { 1, 2 }, { -1, 2 }, { -2, 1 }, { -2, -1 }, { 1, -2 }, { -1, -2 } } };
+	constexpr std::array<Step, 2> pawnSteps{ { { -1, 1 }, { 1, 1 } } };
+
+	template <std::size_t stepCount>
+	constexpr std::array<Targets, squares> makeTargets(const std::array<Step, stepCount>& steps)
+	{
+		std::array<Targets, squares> targets{};
+
+		for (int square{ 0 }; square < squares; ++square)
+			for (const auto& [fileStep, rankStep] : steps)
+			{
+				const int file{ square % lines + fileStep };
+				const int rank{ square / lines + rankStep };
+
+				if (file >= 0 && file < lines && rank >= 0 && rank < lines)
+					targets[square].squares[static_cast<size_t>(targets[square].count++)] = static_cast<std::uint8_t>(rank * lines + file);
+			}
+
+		return targets;
+	}
+
+	constexpr std::array<std::array<Targets, rayDirections.size()>, squares> makeRays()
+	{
+		std::array<std::array<Targets, rayDirections.size()>, squares> rays{};
+
+		for (int square{ 0 }; square < squares; ++square)
+			for (std::size_t direction{ 0 }; direction < rayDirections.size(); ++direction)
+			{
+				const auto [fileStep, rankStep] { rayDirections[direction] };
+				Targets& ray{ rays[square][direction] };
+
+				for (int file{ square % lines + fileStep }, rank{ square / lines + rankStep }; file >= 0 && file < lines && rank >= 0 && rank < lines; file += fileStep, rank += rankStep)
+					ray.squares[static_cast<size_t>(ray.count++)] = static_cast<std::uint8_t>(rank * lines + file);
+			}
+
+		return rays;
+	}
+
+	constexpr auto s_knightTargets{ makeTargets(knightSteps) };
+	constexpr auto s_kingTargets{ makeTargets(rayDirections) };
+	constexpr auto s_pawnTargets{ makeTargets(pawnSteps) };
+	constexpr auto s_rays{ makeRays() };
+
+	void transpose(std::span<const PackedPosition> positions, Batch& batch)
+	{
+		batch.codes = {};
+		batch.pawns = {};
+		batch.size = static_cast<int>(positions.size());
+
+		for (int lane{ 0 }; lane < batch.size; ++lane)
+		{
+			const PackedPosition& position{ positions[static_cast<size_t>(lane)] };
+			const bool isTurned{ (position.state & PackedPosition::blackToMove) != 0 };
+			std::uint64_t occupancy{ position.occupancy };
+
+			for (int index{ 0 }; occupancy != 0; ++index, occupancy &= occupancy - 1)
+			{
+				const int square{ isTurned ? std::countr_zero(occupancy) ^ (squares - lines) : std::countr_zero(occupancy) };
+				const int code{ isTurned ? position.getCode(index) ^ PackedPosition::blackBit : position.getCode(index) };
+				const auto color{ static_cast<size_t>(code >= PackedPosition::blackBit) };
+
+				batch.codes[static_cast<size_t>(square)][static_cast<size_t>(lane)] = static_cast<std::uint8_t>(code);
+
+				if (code % PackedPosition::blackBit == PackedPosition::getCode(Piece::Type::Pawn, Piece::Color::White))
+					batch.pawns[static_cast<size_t>(lane)][color] |= std::uint64_t{ 1 } << square;
+				else if (code % PackedPosition::blackBit == PackedPosition::getCode(Piece::Type::King, Piece::Color::White))
+					batch.kingSquares[static_cast<size_t>(lane)][color] = square;
+			}
+		}
+	}
+
+	//the attacks of a piece kind stepping once to each target, for every lane holding one
+	void addSteps(Lanes& mobility, Lanes movers, const Targets& targets, const std::array<LaneBytes, squares>& notOwn)
+	{
+		for (int i{ 0 }; i < targets.count; ++i)
+			mobility = subtract(mobility, bitAnd(movers, load(notOwn[targets.squares[static_cast<size_t>(i)]].data())));
+	}
+
+	//the ray goes on in the lanes where it keeps finding empty squares, until there are none left
+	void addRay(Lanes& mobility, Lanes movers, const Targets& ray, const std::array<LaneBytes, squares>& notOwn, const std::array<LaneBytes, squares>& empty)
+	{
+		for (int i{ 0 }; i < ray.count && !isNone(movers); ++i)
+		{
+			const std::size_t target{ ray.squares[static_cast<size_t>(i)] };
+			mobility = subtract(mobility, bitAnd(movers, load(notOwn[target].data())));
+			movers = bitAnd(movers, load(empty[target].data()));
+		}
+	}
+
+	void evaluate(const Batch& batch, std::span<int> scores)
+	{
+		const Lanes zero{ broadcast(0) };
+		const Lanes blackBit{ broadcast(PackedPosition::blackBit) };
+
+		alignas(32) std::array<LaneBytes, squares> empty{};
+		alignas(32) std::array<LaneBytes, squares> notOwn{};
+
+		for (int square{ 0 }; square < squares; ++square)
+		{
+			const Lanes code{ load(batch.codes[static_cast<size_t>(square)].data()) };
+			const Lanes isEmpty{ isEqual(code, zero) };
+
+			store(empty[static_cast<size_t>(square)].data(), isEmpty);
+			store(notOwn[static_cast<size_t>(square)].data(), bitOr(isEmpty, isEqual(bitAnd(code, blackBit), blackBit)));
+		}
+
+		//byte counters, the mobility one is moved to wider ones every line before it could overflow
+		Lanes ownCounts[materialTypes]{};		//a plain array, std::array would drop the vector alignment
+		Lanes rivalCounts[materialTypes]{};
+		std::array<int, laneCount> mobility{};
+		Lanes lineMobility{ zero };
+
+		for (int square{ 0 }; square < squares; ++square)
+		{
+			const Lanes code{ load(batch.codes[static_cast<size_t>(square)].data()) };
+			const auto isCode{ [&](Piece::Type type, Piece::Color color) { return isEqual(code, broadcast(static_cast<std::uint8_t>(PackedPosition::getCode(type, color)))); } };
+
+			for (int type{ 0 }; type < materialTypes; ++type)
+			{
+				ownCounts[static_cast<size_t>(type)] = subtract(ownCounts[static_cast<size_t>(type)], isCode(static_cast<Piece::Type>(type), Piece::Color::White));
+				rivalCounts[static_cast<size_t>(type)] = subtract(rivalCounts[static_cast<size_t>(type)], isCode(static_cast<Piece::Type>(type), Piece::Color::Black));
+			}
+
+			const Lanes queens{ isCode(Piece::Type::Queen, Piece::Color::White) };
+			const Lanes straightSliders{ bitOr(isCode(Piece::Type::Rook, Piece::Color::White), queens) };
+			const Lanes diagonalSliders{ bitOr(isCode(Piece::Type::Bishop, Piece::Color::White), queens) };
+
+			addSteps(lineMobility, isCode(Piece::Type::Pawn, Piece::Color::White), s_pawnTargets[static_cast<size_t>(square)], notOwn);
+			addSteps(lineMobility, isCode(Piece::Type::Knight, Piece::Color::White), s_knightTargets[static_cast<size_t>(square)], notOwn);
+			addSteps(lineMobility, isCode(Piece::Type::King, Piece::Color::White), s_kingTargets[static_cast<size_t>(square)], notOwn);
+
+			for (std::size_t direction{ 0 }; direction < rayDirections.size(); ++direction)
+				addRay(lineMobility, (direction < straightRays) ? straightSliders : diagonalSliders, s_rays[static_cast<size_t>(square)][direction], notOwn, empty);
+
+			//a line's pieces attack 8 * 27 squares at most, which still fits in a byte
+			if (square % lines == lines - 1)
+			{
+				alignas(32) LaneBytes lineBytes{};
+				store(lineBytes.data(), lineMobility);
+				lineMobility = zero;
+
+				for (int lane{ 0 }; lane < laneCount; ++lane)
+					mobility[static_cast<size_t>(lane)] += lineBytes[static_cast<size_t>(lane)];
+			}
+		}
+
+		alignas(32) std::array<LaneBytes, materialTypes> ownBytes{};
+		alignas(32) std::array<LaneBytes, materialTypes> rivalBytes{};
+
+		for (int type{ 0 }; type < materialTypes; ++type)
+		{
+			store(ownBytes[static_cast<size_t>(type)].data(), ownCounts[static_cast<size_t>(type)]);
+			store(rivalBytes[static_cast<size_t>(type)].data(), rivalCounts[static_cast<size_t>(type)]);
+		}
+
+		for (int lane{ 0 }; lane < batch.size; ++lane)
+		{
+			const Pawns::Bitboards& pawns{ batch.pawns[static_cast<size_t>(lane)] };
+			int pieces{ 0 };
+
+			for (int type{ 0 }; type < materialTypes; ++type)
+				pieces += ownBytes[static_cast<size_t>(type)][static_cast<size_t>(lane)] + rivalBytes[static_cast<size_t>(type)][static_cast<size_t>(lane)];
+
+			//the side to move is white once turned around
+			if (pieces == 1 && (pawns[0] | pawns[1]) != 0)
+			{
+				const auto pawnColor{ (pawns[0] != 0) ? Piece::Color::White : Piece::Color::Black };
+				const int pawnSquare{ std::countr_zero(pawns[0] | pawns[1]) };
+
+				scores[static_cast<size_t>(lane)] = Kpk::evaluate(Piece::Color::White, pawnColor, pawnSquare, batch.kingSquares[static_cast<size_t>(lane)], Piece::Color::White);
+				continue;
+			}
+
+			int eval{ mobility[static_cast<size_t>(lane)] * EvalParams::mobilityBonus };
+			eval += Pawns::getEval(Pawns::evaluate(batch.pawns[static_cast<size_t>(lane)]), batch.kingSquares[static_cast<size_t>(lane)]);
+
+			for (int type{ 0 }; type < materialTypes; ++type)
+				eval += (ownBytes[static_cast<size_t>(type)][static_cast<size_t>(lane)] - rivalBytes[static_cast<size_t>(type)][static_cast<size_t>(lane)]) * EvalParams::pieceValues[static_cast<size_t>(type)];
+
+			scores[static_cast<size_t>(lane)] = eval;
+		}
+	}
+}
+
+void Evaluation::evaluateBatch(std::span<const PackedPosition> positions, std::span<int> scores)
+{
+	ALLOC_FORBID("Evaluation::evaluateBatch");
+
+	const std::size_t count{ std::min(positions.size(), scores.size()) };
+	Batch batch{};
+
+	for (std::size_t first{ 0 }; first < count; first += laneCount)
+	{
+		const std::size_t size{ std::min(count - first, static_cast<std::size_t>(laneCount)) };
+
+		transpose(positions.subspan(first, size), batch);
+		evaluate(batch, scores.subspan(first, size));
+	}
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "packedPosition.h"
+#include <span>
+
+//classical evaluation of many positions at once
+//
+//positions are transposed into one array per square, holding that square's piece in every position
+//of a batch, so each term is worked out for a register's worth of positions per instruction.
+namespace Evaluation
+{
+	//scores[i] gets the material, mobility and pawn structure eval of positions[i] from its side to move, which is what
+	//Board::getColorEval gives that side without a network loaded, unless one of the kings is mated.
+	//King and pawn against king is looked up in the bitbase, as it is there
+	void evaluateBatch(std::span<const PackedPosition> positions, std::span<int> scores);
+}
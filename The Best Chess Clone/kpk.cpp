@@ -0,0 +1,202 @@
+#include "kpk.h"
+#include "piece.h"
+#include "constants.h"
+#include <array>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace
+{
+	constexpr int lines{ Constants::squaresPerLine };
+	constexpr int squares{ Constants::array2dSize };
+	constexpr int pawnFiles{ 4 };						//e to h are mirrored onto d to a
+	constexpr int pawnRanks{ 6 };						//second to seventh
+	constexpr int positionCount{ 2 * squares * squares * pawnFiles * pawnRanks };
+
+	//flags, so the results of all the moves from a position can be or-ed together
+	enum Result : std::uint8_t
+	{
+		Invalid = 0,
+		Unknown = 1,
+		Draw = 2,
+		Win = 4,
+	};
+
+	//the pawn is white, bit 12 is black to move
+	constexpr int getIndex(int isBlackToMove, int blackKing, int whiteKing, int pawn)
+	{
+		return whiteKing | (blackKing << 6) | (isBlackToMove << 12) | ((pawn % lines) << 13) | ((lines - 2 - pawn / lines) << 15);
+	}
+
+	constexpr int getDistance(int first, int second)
+	{
+		const int files{ first % lines - second % lines };
+		const int ranks{ first / lines - second / lines };
+		return std::max(files < 0 ? -files : files, ranks < 0 ? -ranks : ranks);
+	}
+
+	constexpr std::array<std::uint64_t, squares> makeKingAttacks()
+	{
+		std::array<std::uint64_t, squares> attacks{};
+
+		for (int square{ 0 }; square < squares; ++square)
+			for (int target{ 0 }; target < squares; ++target)
+				if (getDistance(square, target) == 1)
+					attacks[square] |= std::uint64_t{ 1 } << target;
+
+		return attacks;
+	}
+
+	constexpr auto s_kingAttacks{ makeKingAttacks() };
+
+	constexpr std::uint64_t getPawnAttacks(int pawn)
+	{
+		const int file{ pawn % lines };
+		return ((file > 0) ? std::uint64_t{ 1 } << (pawn + lines - 1) : 0) | ((file < lines - 1) ? std::uint64_t{ 1 } << (pawn + lines + 1) : 0);
+	}
+
+	struct Position
+	{
+		int isBlackToMove{};
+		int whiteKing{};
+		int blackKing{};
+		int pawn{};
+	};
+
+	constexpr Position getPosition(int index)
+	{
+		return { (index >> 12) & 1, index & 63, (index >> 6) & 63, (index >> 13 & 3) + (lines - 2 - (index >> 15)) * lines };
+	}
+
+	//what can be told without looking at any move: impossible positions, promotions that can't be stopped,
+	//and black either capturing the pawn, being stalemated or being mated by it
+	constexpr std::uint8_t getInitialResult(const Position& position)
+	{
+		const auto [isBlackToMove, whiteKing, blackKing, pawn] { position };
+		const std::uint64_t pawnAttacks{ getPawnAttacks(pawn) };
+		const std::uint64_t blackKingBit{ std::uint64_t{ 1 } << blackKing };
+
+		if (getDistance(whiteKing, blackKing) <= 1 || whiteKing == pawn || blackKing == pawn || (!isBlackToMove && (pawnAttacks & blackKingBit)))
+			return Invalid;
+
+		const int promotion{ pawn + lines };
+
+		if (!isBlackToMove && pawn / lines == lines - 2 && whiteKing != promotion && (getDistance(blackKing, promotion) > 1 || getDistance(whiteKing, promotion) == 1))
+			return Win;
+
+		if (isBlackToMove)
+		{
+			const std::uint64_t escapes{ s_kingAttacks[blackKing] & ~(s_kingAttacks[whiteKing] | pawnAttacks) };
+
+			if (escapes == 0)
+				return (pawnAttacks & blackKingBit) ? Win : Draw;
+
+			if (escapes & (std::uint64_t{ 1 } << pawn))
+				return Draw;
+		}
+
+		return Unknown;
+	}
+
+	//white wins if any of its moves wins, black draws if any of its moves draws
+	constexpr std::uint8_t classify(const std::uint8_t* results, const Position& position)
+	{
+		const auto [isBlackToMove, whiteKing, blackKing, pawn] { position };
+		const Result good{ isBlackToMove ? Draw : Win };
+		const Result bad{ isBlackToMove ? Win : Draw };
+		std::uint8_t reachable{ Invalid };
+
+		for (std::uint64_t targets{ s_kingAttacks[isBlackToMove ? blackKing : whiteKing] }; targets != 0; targets &= targets - 1)
+		{
+			const int target{ std::countr_zero(targets) };
+			reachable |= isBlackToMove ? results[getIndex(0, target, whiteKing, pawn)] : results[getIndex(1, blackKing, target, pawn)];
+		}
+
+		if (!isBlackToMove)
+		{
+			const int push{ pawn + lines };
+
+			if (push / lines < lines - 1)
+				reachable |= results[getIndex(1, blackKing, whiteKing, push)];
+
+			if (pawn / lines == 1 && push != whiteKing && push != blackKing)
+				reachable |= results[getIndex(1, blackKing, whiteKing, push + lines)];
+		}
+
+		if (reachable & good)
+			return good;
+
+		return (reachable & Unknown) ? Unknown : bad;
+	}
+
+	//positions never settled by the iteration are draws, nothing forces them either way
+	//
+	//a pawn move only leads to positions with the pawn further on, so the pawn squares are solved one at a
+	//time from the seventh rank down, each iterating over its own positions until none of them changes.
+	//The results are a plain array handed around by pointer, which the compiler evaluates far quicker
+	constexpr std::array<std::uint32_t, positionCount / 32> generate()
+	{
+		std::uint8_t results[positionCount]{};
+		constexpr int positionsPerPawn{ 2 * squares * squares };
+
+		for (int index{ 0 }; index < positionCount; ++index)
+			results[index] = getInitialResult(getPosition(index));
+
+		for (int pawnIndex{ 0 }; pawnIndex < pawnFiles * pawnRanks; ++pawnIndex)
+		{
+			const int first{ pawnIndex * positionsPerPawn };
+
+			for (bool hasChanged{ true }; hasChanged;)
+			{
+				hasChanged = false;
+
+				for (int index{ first }; index < first + positionsPerPawn; ++index)
+				{
+					if (results[index] != Unknown)
+						continue;
+
+					results[index] = classify(results, getPosition(index));
+					hasChanged = hasChanged || results[index] != Unknown;
+				}
+			}
+		}
+
+		std::array<std::uint32_t, positionCount / 32> bits{};
+
+		for (int index{ 0 }; index < positionCount; ++index)
+			if (results[index] == Win)
+				bits[index / 32] |= std::uint32_t{ 1 } << (index % 32);
+
+		return bits;
+	}
+
+	constexpr std::array<std::uint32_t, positionCount / 32> s_bitbase{ generate() };
+}
+
+bool Kpk::isWin(Piece::Color pawnColor, int pawnSquare, int strongKingSquare, int weakKingSquare, Piece::Color sideToMove)
+{
+	//turned around so the pawn is white and goes up the board, then mirrored onto the queen's side
+	const int flip{ ((pawnColor == Piece::Color::Black) ? squares - lines : 0) ^ ((pawnSquare % lines >= pawnFiles) ? lines - 1 : 0) };
+	const int pawn{ pawnSquare ^ flip };
+
+	if (pawn / lines < 1 || pawn / lines > lines - 2)
+		return false;
+
+	const int index{ getIndex((sideToMove == pawnColor) ? 0 : 1, weakKingSquare ^ flip, strongKingSquare ^ flip, pawn) };
+	return (s_bitbase[static_cast<size_t>(index / 32)] >> (index % 32)) & 1;
+}
+
+int Kpk::evaluate(Piece::Color color, Piece::Color pawnColor, int pawnSquare, const std::array<int, 2>& kingSquares, Piece::Color sideToMove)
+{
+	const int strongKingSquare{ kingSquares[static_cast<size_t>(pawnColor)] };
+	const int weakKingSquare{ kingSquares[static_cast<size_t>(!pawnColor)] };
+
+	if (!isWin(pawnColor, pawnSquare, strongKingSquare, weakKingSquare, sideToMove))
+		return 0;
+
+	const int rank{ pawnSquare / lines };
+	const int eval{ winEval + rankBonus * ((pawnColor == Piece::Color::White) ? rank : lines - 1 - rank) };
+
+	return (color == pawnColor) ? eval : -eval;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "piece.h"
+#include <array>
+
+//king and pawn against king, solved while compiling
+//
+//every placement of the kings and the pawn, with either side to move, is a bit telling whether the pawn's
+//side wins, 2 * 64 * 64 * 24 of them (the pawn is mirrored onto files a to d) packed into 24 KB.
+//The table is worked out by retrograde iteration in a constexpr function, so the binary just holds it.
+namespace Kpk
+{
+	inline constexpr int winEval{ 700 };				//what a won ending is worth to the pawn's side, still less than a queen
+	inline constexpr int rankBonus{ 10 };				//per rank the pawn has gone, so a won one gets pushed on
+
+	//squares are numbered from white's side, a1 = 0
+	bool isWin(Piece::Color pawnColor, int pawnSquare, int strongKingSquare, int weakKingSquare, Piece::Color sideToMove);
+
+	//from the color's side, kingSquares by color
+	int evaluate(Piece::Color color, Piece::Color pawnColor, int pawnSquare, const std::array<int, 2>& kingSquares, Piece::Color sideToMove);
+}
@@ -0,0 +1,247 @@
+#include "learning.h"
+#include "mappedFile.h"
+#include "zobrist.h"
+#include <string_view>
+#include <string>
+#include <span>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+	MappedFile s_file{};
+	std::string s_path{};
+	std::span<const Learning::Entry> s_sorted{};
+	std::unordered_map<Zobrist::Key, Learning::Entry> s_log{};		//the deepest logged entry of each key
+	std::size_t s_logCount{ 0 };									//records in the file's log, repeated keys included
+	bool s_isLoaded{ false };
+
+	std::uint8_t getCheck(const Learning::Entry& entry)
+	{
+		Zobrist::Key state{ entry.key ^ (static_cast<std::uint64_t>(static_cast<std::uint32_t>(entry.eval)) << 16) };
+		state ^= static_cast<std::uint64_t>(entry.move) | (static_cast<std::uint64_t>(static_cast<std::uint8_t>(entry.deepness)) << 56);
+		return static_cast<std::uint8_t>(Zobrist::splitMix64(state));
+	}
+
+	//a deeper search wins, and on a tie the newer one
+	void merge(const Learning::Entry& entry)
+	{
+		const auto [slot, isNew] { s_log.try_emplace(entry.key, entry) };
+
+		if (!isNew && entry.deepness >= slot->second.deepness)
+			slot->second = entry;
+	}
+
+	bool writeHeader(std::ofstream& output, std::uint64_t sortedCount)
+	{
+		output.write(Learning::magic.data(), static_cast<std::streamsize>(Learning::magic.size()));
+		output.write(reinterpret_cast<const char*>(&sortedCount), sizeof(sortedCount));
+		return static_cast<bool>(output);
+	}
+
+	bool writeEntries(std::ofstream& output, std::span<const Learning::Entry> entries)
+	{
+		for (Learning::Entry entry : entries)
+		{
+			entry.check = getCheck(entry);
+			output.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+		}
+
+		output.flush();
+		return static_cast<bool>(output);
+	}
+
+	bool map()
+	{
+		MappedFile file{};
+
+		if (!file.open(s_path))
+			return false;
+
+		const auto data{ file.getData() };
+		std::uint64_t sortedCount{};
+
+		if (data.size() < Learning::headerSize || std::memcmp(data.data(), Learning::magic.data(), Learning::magic.size()) != 0)
+			return false;
+
+		std::memcpy(&sortedCount, data.data() + Learning::magic.size(), sizeof(sortedCount));
+
+		if (sortedCount > (data.size() - Learning::headerSize) / sizeof(Learning::Entry))
+			return false;
+
+		s_sorted = { reinterpret_cast<const Learning::Entry*>(data.data() + Learning::headerSize), static_cast<std::size_t>(sortedCount) };
+		s_file = std::move(file);
+
+		return true;
+	}
+
+	//the file is closed while it's written, some systems won't write to a mapped one
+	void unmap()
+	{
+		s_sorted = {};
+		s_file.close();
+	}
+
+	//every key's deepest entry written sorted to a new file, which then takes the old one's place
+	bool compact()
+	{
+		std::vector<Learning::Entry> entries{ s_sorted.begin(), s_sorted.end() };
+
+		for (const auto& [key, entry] : s_log)
+			entries.push_back(entry);
+
+		//stable, so a logged entry comes after the sorted one of its key and wins a tie
+		std::stable_sort(entries.begin(), entries.end(), [](const Learning::Entry& a, const Learning::Entry& b) { return a.key < b.key; });
+
+		std::vector<Learning::Entry> compacted{};
+		compacted.reserve(entries.size());
+
+		for (const auto& entry : entries)
+		{
+			if (!compacted.empty() && compacted.back().key == entry.key)
+			{
+				if (entry.deepness >= compacted.back().deepness)
+					compacted.back() = entry;
+
+				continue;
+			}
+
+			compacted.push_back(entry);
+		}
+
+		const std::string temporaryPath{ s_path + ".tmp" };
+
+		{
+			std::ofstream output{ temporaryPath, std::ios::binary | std::ios::trunc };
+
+			if (!writeHeader(output, compacted.size()) || !writeEntries(output, compacted))
+				return false;
+		}
+
+		unmap();
+
+		std::error_code error{};
+		std::filesystem::rename(temporaryPath, s_path, error);
+
+		if (error)
+			return false;
+
+		s_log.clear();
+		s_logCount = 0;
+
+		return true;
+	}
+}
+
+bool Learning::load(std::string_view path)
+{
+	unmap();
+	s_path = path;
+	s_log.clear();
+	s_logCount = 0;
+	s_isLoaded = false;
+
+	std::error_code error{};
+
+	if (std::filesystem::file_size(s_path, error) == 0 && !error)
+	{
+		std::ofstream output{ s_path, std::ios::binary | std::ios::trunc };
+
+		if (!writeHeader(output, 0))
+			return false;
+	}
+
+	if (!map())
+		return false;
+
+	//a partial record at the end is what a crash while appending leaves, cut off so the next appends line up
+	const std::size_t logStart{ headerSize + s_sorted.size() * sizeof(Entry) };
+	const std::size_t partialBytes{ (s_file.getData().size() - logStart) % sizeof(Entry) };
+
+	if (partialBytes > 0)
+	{
+		const std::size_t size{ s_file.getData().size() - partialBytes };
+
+		unmap();
+		std::filesystem::resize_file(s_path, size, error);
+
+		if (error || !map())
+			return false;
+	}
+
+	const auto data{ s_file.getData() };
+
+	for (std::size_t offset{ logStart }; offset + sizeof(Entry) <= data.size(); offset += sizeof(Entry))
+	{
+		Entry entry{};
+		std::memcpy(&entry, data.data() + offset, sizeof(entry));
+
+		if (entry.check == getCheck(entry))
+			merge(entry);
+
+		++s_logCount;
+	}
+
+	s_isLoaded = true;
+	return true;
+}
+
+bool Learning::isLoaded()
+{
+	return s_isLoaded;
+}
+
+const Learning::Entry* Learning::find(Zobrist::Key key)
+{
+	const auto sorted{ std::lower_bound(s_sorted.begin(), s_sorted.end(), key, [](const Entry& entry, Zobrist::Key key) { return entry.key < key; }) };
+	const Entry* sortedEntry{ (sorted != s_sorted.end() && sorted->key == key) ? &*sorted : nullptr };
+
+	const auto logged{ s_log.find(key) };
+	const Entry* loggedEntry{ (logged != s_log.end()) ? &logged->second : nullptr };
+
+	if (!loggedEntry || (sortedEntry && sortedEntry->deepness > loggedEntry->deepness))
+		return sortedEntry;
+
+	return loggedEntry;
+}
+
+bool Learning::save(std::span<const Entry> entries)
+{
+	if (!s_isLoaded)
+		return false;
+
+	unmap();
+
+	bool isSaved{ false };
+
+	{
+		std::ofstream output{ s_path, std::ios::binary | std::ios::app };
+		isSaved = writeEntries(output, entries);
+	}
+
+	for (const auto& entry : entries)
+		merge(entry);
+
+	s_logCount += entries.size();
+
+	if (!map())
+	{
+		s_isLoaded = false;
+		return false;
+	}
+
+	if (s_logCount >= std::max(minCompaction, s_sorted.size()))
+		isSaved = compact() && isSaved;
+
+	if (!s_file.isOpen() && !map())
+		s_isLoaded = false;
+
+	return isSaved && s_isLoaded;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "zobrist.h"
+#include "move.h"
+#include <string_view>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+//optional cache of the AI's searches, kept on disk from one game and one run to the next
+//
+//the file is memory-mapped and read in place. All values are little-endian:
+//	header			"BCCLRN01", then uint64 sortedCount
+//	Entry			sorted[sortedCount], by key and one per key, as the last compaction left them
+//	Entry			log[], appended after every game, each checked by its check byte
+//a record cut short or garbled by a crash while appending fails its check and is skipped, and a compaction
+//writes the whole file anew beside the old one before renaming it over it. An empty file is a new cache.
+//
+//loading and saving belong to whoever plays the games, finding may be done by the searches in between
+namespace Learning
+{
+	inline constexpr std::string_view magic{ "BCCLRN01" };
+	inline constexpr std::size_t headerSize{ 16 };
+	inline constexpr int minDeepness{ 1 };			//shallower searches aren't worth keeping
+	inline constexpr int maxProbePly{ 2 };			//the search looks entries up this close to the root
+	inline constexpr std::size_t minCompaction{ 4096 };	//log records before it's worth compacting them
+
+	struct Entry
+	{
+		Zobrist::Key key{ 0 };
+		std::int32_t eval{ 0 };			//from the side to move
+		std::uint16_t move{ 0 };			//as in Move::getData
+		std::int8_t deepness{ -1 };
+		std::uint8_t check{ 0 };			//of the fields above, only meaningful in the file
+	};
+
+	static_assert(sizeof(Entry) == 16);
+
+	bool load(std::string_view path);
+	bool isLoaded();
+
+	//the deepest search of the key, or nullptr when there is none
+	const Entry* find(Zobrist::Key key);
+
+	//appends the entries to the file, and compacts it once its log outgrows the sorted part
+	bool save(std::span<const Entry> entries);
+}
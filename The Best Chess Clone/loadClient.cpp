@@ -0,0 +1,423 @@
+#include "board.h"
+#include "piece.h"
+#include "move.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cerrno>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <random>
+#include <optional>
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <cstdint>
+
+//load generator for chess_server: many connections, each playing many games of random legal moves at once
+//
+//usage: chess_load [options]
+//	--port n			the server's TCP port on 127.0.0.1 (default 7878)
+//	--unix path			connect to this Unix socket instead
+//	--connections n		connections, one thread each (default 8)
+//	--games n			games kept going on every connection (default 128)
+//	--duration s		seconds to run for (default 10)
+//	--seed n			seed for the random moves (default 1)
+//
+//the latency reported is the round trip seen by the client, from sending a move to reading the engine's reply
+
+namespace
+{
+	struct Options
+	{
+		int port{ 7878 };
+		std::string unixPath{};
+		int connections{ 8 };
+		int games{ 128 };
+		std::chrono::seconds duration{ 10 };
+		std::uint64_t seed{ 1 };
+	};
+
+	struct Tally
+	{
+		std::uint64_t moves{ 0 };
+		std::uint64_t games{ 0 };
+		std::uint64_t errors{ 0 };
+		std::vector<double> latencies{};	//in milliseconds
+	};
+
+	//the client's copy of a game, to pick its moves from
+	struct ClientGame
+	{
+		Board board{ Piece::Color::White };
+		std::chrono::steady_clock::time_point sendTime{};
+	};
+
+	std::optional<Options> parseOptions(int argc, char** argv)
+	{
+		Options options{};
+
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			const std::string_view argument{ argv[i] };
+
+			if (!argument.starts_with("--") || i + 1 >= argc)
+				return std::nullopt;
+
+			const std::string_view name{ argument.substr(2) };
+			const char* value{ argv[++i] };
+
+			if (name == "port")
+				options.port = std::stoi(value);
+			else if (name == "unix")
+				options.unixPath = value;
+			else if (name == "connections")
+				options.connections = std::max(std::stoi(value), 1);
+			else if (name == "games")
+				options.games = std::max(std::stoi(value), 1);
+			else if (name == "duration")
+				options.duration = std::chrono::seconds{ std::max(std::stoi(value), 1) };
+			else if (name == "seed")
+				options.seed = std::stoull(value);
+			else
+				return std::nullopt;
+		}
+
+		return options;
+	}
+
+	int connect(const Options& options)
+	{
+		int fd{ -1 };
+
+		if (!options.unixPath.empty())
+		{
+			sockaddr_un address{};
+			address.sun_family = AF_UNIX;
+
+			if (options.unixPath.size() >= sizeof(address.sun_path))
+				return -1;
+
+			std::copy(options.unixPath.begin(), options.unixPath.end(), address.sun_path);
+
+			fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+			if (fd >= 0 && ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0)
+			{
+				close(fd);
+				fd = -1;
+			}
+		}
+		else
+		{
+			sockaddr_in address{};
+			address.sin_family = AF_INET;
+			address.sin_port = htons(static_cast<std::uint16_t>(options.port));
+			address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+			fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+			if (fd >= 0 && ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0)
+			{
+				close(fd);
+				fd = -1;
+			}
+
+			const int enable{ 1 };
+
+			if (fd >= 0)
+				setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+		}
+
+		//a read times out now and then, so the deadline is noticed even if the server goes quiet
+		const timeval timeout{ 0, 200000 };
+
+		if (fd >= 0)
+			setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+		return fd;
+	}
+
+	bool sendAll(int fd, std::string_view text)
+	{
+		while (!text.empty())
+		{
+			const ssize_t bytes{ send(fd, text.data(), text.size(), MSG_NOSIGNAL) };
+
+			if (bytes <= 0)
+				return false;
+
+			text.remove_prefix(static_cast<size_t>(bytes));
+		}
+
+		return true;
+	}
+
+	//reads the next line, or nothing if none arrived before the socket's timeout
+	std::optional<std::string> readLine(int fd, std::string& buffer, bool& isClosed)
+	{
+		while (true)
+		{
+			const std::size_t lineEnd{ buffer.find('\n') };
+
+			if (lineEnd != std::string::npos)
+			{
+				std::string line{ buffer.substr(0, lineEnd) };
+				buffer.erase(0, lineEnd + 1);
+				return line;
+			}
+
+			char chunk[4096]{};
+			const ssize_t bytes{ recv(fd, chunk, sizeof(chunk), 0) };
+
+			if (bytes <= 0)
+			{
+				isClosed = bytes == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+				return std::nullopt;
+			}
+
+			buffer.append(chunk, static_cast<size_t>(bytes));
+		}
+	}
+
+	std::vector<std::string_view> split(std::string_view line)
+	{
+		std::vector<std::string_view> words{};
+
+		while (!line.empty())
+		{
+			const std::size_t start{ line.find_first_not_of(' ') };
+
+			if (start == std::string_view::npos)
+				break;
+
+			line.remove_prefix(start);
+
+			const std::size_t end{ std::min(line.find(' '), line.size()) };
+			words.push_back(line.substr(0, end));
+			line.remove_prefix(end);
+		}
+
+		return words;
+	}
+
+	std::optional<int> toInt(std::string_view text)
+	{
+		int value{};
+		const auto [end, error] { std::from_chars(text.data(), text.data() + text.size(), value) };
+
+		if (error != std::errc{} || end != text.data() + text.size())
+			return std::nullopt;
+
+		return value;
+	}
+
+	//plays its games until the deadline, then drops the connection and lets the server clean up
+	void runConnection(const Options& options, int index, std::chrono::steady_clock::time_point deadline, Tally& tally)
+	{
+		const int fd{ connect(options) };
+
+		if (fd < 0)
+		{
+			++tally.errors;
+			return;
+		}
+
+		std::mt19937_64 random{ options.seed * 0x9E3779B97F4A7C15ull + static_cast<std::uint64_t>(index) };
+		std::unordered_map<int, ClientGame> games{};
+		std::deque<Piece::Color> pendingColors{};		//the server answers new games in the order they were asked for
+		std::string buffer{};
+		std::string requests{};
+		bool isClosed{ false };
+
+		const auto startGame
+		{
+			[&]()
+			{
+				const Piece::Color color{ (random() % 2 == 0) ? Piece::Color::White : Piece::Color::Black };
+				pendingColors.push_back(color);
+				requests += (color == Piece::Color::White) ? "new white\n" : "new black\n";
+			}
+		};
+
+		const auto playMove
+		{
+			[&](int gameId, ClientGame& game)
+			{
+				const auto& moves{ game.board.getLegalMoves() };
+				const Move move{ moves[random() % moves.size()] };
+
+				game.board.makeMove(move);
+				game.sendTime = std::chrono::steady_clock::now();
+				requests += "move " + std::to_string(gameId) + ' ' + move.toString() + '\n';
+			}
+		};
+
+		const auto endGame
+		{
+			[&](int gameId)
+			{
+				games.erase(gameId);
+				++tally.games;
+
+				if (std::chrono::steady_clock::now() < deadline)
+					startGame();
+			}
+		};
+
+		for (int i{ 0 }; i < options.games; ++i)
+			startGame();
+
+		while (!isClosed && std::chrono::steady_clock::now() < deadline)
+		{
+			if (!requests.empty() && !sendAll(fd, std::exchange(requests, {})))
+				break;
+
+			const auto line{ readLine(fd, buffer, isClosed) };
+
+			if (!line)
+				continue;
+
+			const auto words{ split(line.value()) };
+			const auto gameId{ (words.size() >= 2) ? toInt(words[1]) : std::nullopt };
+
+			if (words.size() == 2 && words[0] == "game" && gameId && !pendingColors.empty())
+			{
+				const Piece::Color color{ pendingColors.front() };
+				pendingColors.pop_front();
+
+				ClientGame& game{ games[gameId.value()] };
+				game.sendTime = std::chrono::steady_clock::now();
+
+				if (color == Piece::Color::White)
+					playMove(gameId.value(), game);
+			}
+			else if (words.size() == 4 && words[0] == "ai" && gameId && games.contains(gameId.value()))
+			{
+				ClientGame& game{ games[gameId.value()] };
+
+				++tally.moves;
+				tally.latencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - game.sendTime).count());
+
+				const auto move{ game.board.parseMove(words[2]) };
+
+				if (!move)
+				{
+					++tally.errors;
+					endGame(gameId.value());
+					continue;
+				}
+
+				game.board.makeMove(move.value());
+
+				if (words[3] == "ongoing")
+					playMove(gameId.value(), game);
+				else
+					endGame(gameId.value());
+			}
+			else if (words.size() == 3 && words[0] == "over" && gameId)
+			{
+				endGame(gameId.value());
+			}
+			else
+			{
+				//illegal moves, busy servers and anything unexpected end the game they're about
+				++tally.errors;
+
+				if (gameId && games.contains(gameId.value()))
+				{
+					requests += "resign " + std::to_string(gameId.value()) + '\n';
+					endGame(gameId.value());
+				}
+			}
+		}
+
+		close(fd);
+	}
+
+	double getPercentile(std::vector<double>& values, double percentile)
+	{
+		if (values.empty())
+			return 0.0;
+
+		const auto rank{ static_cast<std::size_t>(percentile / 100.0 * static_cast<double>(values.size() - 1) + 0.5) };
+		std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(rank), values.end());
+
+		return values[rank];
+	}
+
+	//asks the server for its own view of the run, on a connection of its own
+	std::optional<std::string> getServerStats(const Options& options)
+	{
+		const int fd{ connect(options) };
+
+		if (fd < 0 || !sendAll(fd, "stats\n"))
+			return std::nullopt;
+
+		std::string buffer{};
+		bool isClosed{ false };
+		std::optional<std::string> line{};
+
+		for (int attempt{ 0 }; attempt < 10 && !line && !isClosed; ++attempt)
+			line = readLine(fd, buffer, isClosed);
+
+		close(fd);
+
+		return line;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const auto options{ parseOptions(argc, argv) };
+
+	if (!options)
+	{
+		std::cout << "usage: chess_load [--port n | --unix path] [--connections n] [--games n] [--duration s] [--seed n]\n";
+		return 1;
+	}
+
+	const auto startTime{ std::chrono::steady_clock::now() };
+	const auto deadline{ startTime + options->duration };
+
+	std::vector<Tally> tallies(static_cast<size_t>(options->connections));
+	std::vector<std::thread> connections{};
+
+	for (int i{ 0 }; i < options->connections; ++i)
+		connections.emplace_back(runConnection, std::cref(options.value()), i, deadline, std::ref(tallies[static_cast<size_t>(i)]));
+
+	for (auto& connection : connections)
+		connection.join();
+
+	const double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() };
+	Tally total{};
+
+	for (auto& tally : tallies)
+	{
+		total.moves += tally.moves;
+		total.games += tally.games;
+		total.errors += tally.errors;
+		total.latencies.insert(total.latencies.end(), tally.latencies.begin(), tally.latencies.end());
+	}
+
+	std::cout << std::fixed << std::setprecision(2)
+		<< "Concurrent games " << options->connections * options->games
+		<< "  finished " << total.games << "  moves " << total.moves << "  " << static_cast<double>(total.moves) / seconds << " moves/s"
+		<< "  p50 " << getPercentile(total.latencies, 50.0) << " ms  p99 " << getPercentile(total.latencies, 99.0) << " ms"
+		<< "  errors " << total.errors << '\n';
+
+	if (const auto stats{ getServerStats(options.value()) })
+		std::cout << "Server: " << stats.value() << '\n';
+
+	return 0;
+}
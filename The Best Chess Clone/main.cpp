@@ -1,9 +1,15 @@
 #include "chess.h"
+#include "bench.h"
 #include <iostream>
+#include <string_view>
 #include <cstdlib>
 
-int main(int, char**)
+int main(int argc, char** argv)
 {
+	//bench [depth] runs the search benchmark instead of the game, without opening a window
+	if (argc > 1 && std::string_view{ argv[1] } == "bench")
+		return Bench::runCommand({ argv + 2, static_cast<size_t>(argc - 2) });
+
 	srand(time(0));
 
 	Chess chess{};
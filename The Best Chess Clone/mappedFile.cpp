@@ -0,0 +1,122 @@
+#include "mappedFile.h"
+#include <string_view>
+#include <string>
+#include <utility>
+#include <cstddef>
+#include <span>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+MappedFile::MappedFile(MappedFile&& file) noexcept
+	: m_data{ std::exchange(file.m_data, nullptr) }, m_size{ std::exchange(file.m_size, 0) } {}
+
+MappedFile& MappedFile::operator=(MappedFile&& file) noexcept
+{
+	if (this != &file)
+	{
+		close();
+		m_data = std::exchange(file.m_data, nullptr);
+		m_size = std::exchange(file.m_size, 0);
+	}
+
+	return *this;
+}
+
+bool MappedFile::open(std::string_view path)
+{
+	close();
+
+	const std::string pathString{ path };
+
+#ifdef _WIN32
+	HANDLE file{ CreateFileA(pathString.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size{};
+
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping{ CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) };
+	CloseHandle(file);
+
+	if (!mapping)
+		return false;
+
+	void* data{ MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) };
+	CloseHandle(mapping);
+
+	if (!data)
+		return false;
+
+	m_size = static_cast<std::size_t>(size.QuadPart);
+#else
+	const int file{ ::open(pathString.c_str(), O_RDONLY) };
+
+	if (file < 0)
+		return false;
+
+	struct stat status{};
+
+	if (fstat(file, &status) != 0 || status.st_size == 0)
+	{
+		::close(file);
+		return false;
+	}
+
+	void* data{ mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, file, 0) };
+	::close(file);
+
+	if (data == MAP_FAILED)
+		return false;
+
+	m_size = static_cast<std::size_t>(status.st_size);
+#endif
+
+	m_data = static_cast<const std::byte*>(data);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (!m_data)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_data);
+#else
+	munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+
+	m_data = nullptr;
+	m_size = 0;
+}
+
+bool MappedFile::isOpen() const
+{
+	return m_data != nullptr;
+}
+
+std::span<const std::byte> MappedFile::getData() const
+{
+	return { m_data, m_size };
+}
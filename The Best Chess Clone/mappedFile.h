@@ -0,0 +1,29 @@
+#pragma once
+#include <string_view>
+#include <cstddef>
+#include <span>
+
+//read-only memory mapping of a whole file, unmapped when destroyed
+class MappedFile
+{
+	public:
+
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(MappedFile&& file) noexcept;
+		MappedFile& operator=(MappedFile&& file) noexcept;
+
+		bool open(std::string_view path);
+		void close();
+		bool isOpen() const;
+		std::span<const std::byte> getData() const;
+
+	private:
+
+		const std::byte* m_data{ nullptr };
+		std::size_t m_size{ 0 };
+
+		MappedFile(const MappedFile&) = delete;
+		void operator=(const MappedFile&) = delete;
+};
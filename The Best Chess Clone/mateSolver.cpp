@@ -0,0 +1,370 @@
+#include "mateSolver.h"
+#include "board.h"
+#include "piece.h"
+#include "move.h"
+#include "zobrist.h"
+#include "trace.h"
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+
+namespace
+{
+	using MateSolver::Entry;
+	using MateSolver::infinity;
+
+	struct Search
+	{
+		MateSolver::Table& table;
+		Piece::Color attacker{};
+		std::uint64_t nodes{ 0 };
+		std::uint64_t nodeLimit{ 0 };
+		const std::atomic<bool>* isStopped{ nullptr };
+		bool isAborted{ false };
+	};
+
+	//a position one move away, with its numbers as they stand
+	struct Child
+	{
+		Move move{};
+		Entry entry{};
+		bool isSettled{ false };		//mated, drawn or too deep, which the table never holds
+	};
+
+	void countNode(Search& search)
+	{
+		++search.nodes;
+
+		if (search.nodeLimit > 0 && search.nodes >= search.nodeLimit)
+			search.isAborted = true;
+
+		if (search.isStopped && search.isStopped->load(std::memory_order_relaxed))
+			search.isAborted = true;
+	}
+
+	std::uint32_t add(std::uint64_t first, std::uint64_t second)
+	{
+		return static_cast<std::uint32_t>(std::min<std::uint64_t>(first + second, std::numeric_limits<std::uint32_t>::max()));
+	}
+
+	//the side to move's goal is mating for the attacker and not being mated for the defender, so a draw is a loss for
+	//the first and a win for the second, and a lost position is set down as mated either way
+	Child getChild(const Board& board, Move move, int ply, Search& search)
+	{
+		Board position{ board };
+		position.makeMove(move);
+		countNode(search);
+
+		Child child{ move, Entry{ position.getPositionKey() } };
+		const bool isAttacker{ position.getColorToMove() == search.attacker };
+		const Entry lost{ child.entry.key, infinity, 0 };
+		const Entry won{ child.entry.key, 0, infinity };
+
+		if (position.isSearchDraw())
+		{
+			child.entry = isAttacker ? lost : won;
+			child.isSettled = true;
+			return child;
+		}
+
+		const auto& moves{ position.getLegalMoves() };
+
+		if (moves.empty())
+		{
+			child.entry = (position.isKingChecked(position.getColorToMove()) || isAttacker) ? lost : won;
+			child.isSettled = true;
+		}
+		else if (ply >= MateSolver::maxPlies)
+		{
+			child.entry = isAttacker ? lost : won;
+			child.isSettled = true;
+		}
+		else if (const Entry* entry{ search.table.find(child.entry.key) })
+		{
+			child.entry = *entry;
+		}
+		else
+		{
+			//the fewer replies, the quicker it's likely to be settled either way
+			child.entry.disproof = static_cast<std::uint32_t>(moves.size());
+		}
+
+		return child;
+	}
+
+	//the position wins as soon as one move leaves the rival lost, and loses once every move leaves it winning
+	Entry getEntry(Zobrist::Key key, const std::vector<Child>& children)
+	{
+		Entry entry{ key, infinity, 0 };
+		std::uint64_t disproof{ 0 };
+		bool isDisproven{ false };
+		int shortestMate{ std::numeric_limits<int>::max() };
+		int longestMate{ 0 };
+
+		for (const Child& child : children)
+		{
+			entry.proof = std::min(entry.proof, child.entry.disproof);
+			disproof += child.entry.proof;
+			isDisproven = isDisproven || child.entry.proof >= infinity;
+			longestMate = std::max(longestMate, static_cast<int>(child.entry.mateDistance));
+
+			if (child.entry.disproof == 0)
+				shortestMate = std::min(shortestMate, static_cast<int>(child.entry.mateDistance));
+		}
+
+		entry.disproof = isDisproven ? infinity : static_cast<std::uint32_t>(std::min<std::uint64_t>(disproof, infinity - 1));
+
+		//the winner takes the shortest way, and the loser holds out the longest
+		if (entry.proof == 0)
+			entry.mateDistance = static_cast<std::uint16_t>(shortestMate + 1);
+		else if (entry.disproof == 0)
+			entry.mateDistance = static_cast<std::uint16_t>(longestMate + 1);
+
+		return entry;
+	}
+
+	std::vector<Child> getChildren(Board& board, int ply, Search& search)
+	{
+		const auto& moves{ board.getLegalMoves() };
+		std::vector<Child> children{};
+		children.reserve(moves.size());
+
+		for (const Move move : moves)
+			children.push_back(getChild(board, move, ply + 1, search));
+
+		return children;
+	}
+
+	//Nagai's multiple iterative deepening, going on below the position until its proof or disproof number reaches its threshold,
+	//both from the side to move. The board has legal moves and isn't drawn, getChild would have settled it otherwise
+	Entry searchPosition(Board& board, int ply, std::uint32_t proofThreshold, std::uint32_t disproofThreshold, Search& search)
+	{
+		TRACE_SCOPE("MateSolver::searchPosition");
+
+		const std::uint64_t initialNodes{ search.nodes };
+		const Entry* previousEntry{ search.table.find(board.getPositionKey()) };
+		const std::uint32_t previousWork{ previousEntry ? previousEntry->work : 0 };
+
+		std::vector<Child> children{ getChildren(board, ply, search) };
+
+		//numbers of a half expanded position would be wrong, not just unsettled
+		if (search.isAborted)
+			return Entry{ board.getPositionKey() };
+
+		Entry entry{};
+
+		while (true)
+		{
+			for (Child& child : children)
+				if (!child.isSettled)
+					if (const Entry* stored{ search.table.find(child.entry.key) })
+						child.entry = *stored;
+
+			entry = getEntry(board.getPositionKey(), children);
+
+			if (entry.proof >= proofThreshold || entry.disproof >= disproofThreshold || search.isAborted)
+				break;
+
+			//the child closest to being lost for the rival, with the runner up setting how far it's followed
+			Child* best{ nullptr };
+			std::uint32_t secondDisproof{ infinity };
+
+			for (Child& child : children)
+			{
+				if (!best || child.entry.disproof < best->entry.disproof)
+				{
+					if (best)
+						secondDisproof = best->entry.disproof;
+
+					best = &child;
+				}
+				else
+				{
+					secondDisproof = std::min(secondDisproof, child.entry.disproof);
+				}
+			}
+
+			const std::uint64_t childProofThreshold{ std::uint64_t{ disproofThreshold } - entry.disproof + best->entry.proof };
+			const std::uint64_t childDisproofThreshold{ std::min<std::uint64_t>(proofThreshold, std::uint64_t{ secondDisproof } + 1) };
+
+			Board position{ board };
+			position.makeMove(best->move);
+
+			best->entry = searchPosition
+			(
+				position, ply + 1,
+				static_cast<std::uint32_t>(std::min<std::uint64_t>(childProofThreshold, infinity)),
+				static_cast<std::uint32_t>(std::min<std::uint64_t>(childDisproofThreshold, infinity)),
+				search
+			);
+		}
+
+		entry.work = add(previousWork, search.nodes - initialNodes);
+		search.table.store(entry);
+
+		return entry;
+	}
+
+	//what a child not settled by the table is worth, searched until it is
+	void settle(const Board& board, Child& child, int ply, Search& search)
+	{
+		if (child.isSettled || child.entry.proof == 0 || child.entry.disproof == 0)
+			return;
+
+		Board position{ board };
+		position.makeMove(child.move);
+		child.entry = searchPosition(position, ply + 1, infinity, infinity, search);
+	}
+
+	//the attacker's quickest mate against the defender's longest resistance, searching again what the table lost
+	std::vector<Move> getLine(const Board& root, Search& search)
+	{
+		std::vector<Move> line{};
+		Board board{ root };
+
+		while (static_cast<int>(line.size()) < MateSolver::maxPlies && !board.getLegalMoves().empty())
+		{
+			const bool isAttacker{ board.getColorToMove() == search.attacker };
+			const int ply{ static_cast<int>(line.size()) };
+			std::vector<Child> children{ getChildren(board, ply, search) };
+			const Child* next{ nullptr };
+
+			if (isAttacker)
+			{
+				for (const Child& child : children)
+					if (child.entry.disproof == 0 && (!next || child.entry.mateDistance < next->entry.mateDistance))
+						next = &child;
+
+				for (auto child{ children.begin() }; !next && child != children.end() && !search.isAborted; ++child)
+				{
+					settle(board, *child, ply, search);
+
+					if (child->entry.disproof == 0)
+						next = &*child;
+				}
+			}
+			else
+			{
+				for (Child& child : children)
+				{
+					settle(board, child, ply, search);
+
+					//a defence the proof didn't cover, which only a key collision would leave
+					if (child.entry.proof != 0)
+						return line;
+
+					if (!next || child.entry.mateDistance > next->entry.mateDistance)
+						next = &child;
+				}
+			}
+
+			if (!next || search.isAborted)
+				break;
+
+			line.push_back(next->move);
+			board.makeMove(next->move);
+		}
+
+		return line;
+	}
+}
+
+MateSolver::Table::Table()
+	: m_entries(static_cast<size_t>(tableSize))
+{
+}
+
+//a new solve only sees what it stored itself, without going over the whole table
+void MateSolver::Table::startSolve()
+{
+	if (++m_generation == 0)
+	{
+		std::fill(m_entries.begin(), m_entries.end(), Entry{});
+		m_generation = 1;
+	}
+}
+
+const MateSolver::Entry* MateSolver::Table::find(Zobrist::Key key) const
+{
+	const Entry* bucket{ getBucket(key) };
+
+	for (int i{ 0 }; i < bucketSize; ++i)
+		if (bucket[i].key == key && bucket[i].generation == m_generation)
+			return &bucket[i];
+
+	return nullptr;
+}
+
+//into the key's own slot, a free or stale one, or else the one with the least work
+void MateSolver::Table::store(Entry entry)
+{
+	Entry* bucket{ getBucket(entry.key) };
+	Entry* slot{ &bucket[0] };
+
+	entry.generation = m_generation;
+
+	for (int i{ 0 }; i < bucketSize; ++i)
+	{
+		if (bucket[i].key == entry.key || bucket[i].generation != m_generation)
+		{
+			slot = &bucket[i];
+			break;
+		}
+
+		if (bucket[i].work < slot->work)
+			slot = &bucket[i];
+	}
+
+	*slot = entry;
+}
+
+MateSolver::Entry* MateSolver::Table::getBucket(Zobrist::Key key)
+{
+	return &m_entries[static_cast<size_t>(key & (tableSize - bucketSize))];
+}
+
+const MateSolver::Entry* MateSolver::Table::getBucket(Zobrist::Key key) const
+{
+	return &m_entries[static_cast<size_t>(key & (tableSize - bucketSize))];
+}
+
+MateSolver::Result MateSolver::solve(const Board& board, std::uint64_t nodes, Table& table, const std::atomic<bool>* isStopped)
+{
+	TRACE_SCOPE("MateSolver::solve");
+
+	Board root{ board };
+	root.clearSearch();
+
+	Result result{};
+	Search search{ table, root.getColorToMove(), 0, nodes, isStopped };
+
+	if (root.getLegalMoves().empty())
+	{
+		result.status = Status::NoMate;
+		return result;
+	}
+
+	table.startSolve();
+
+	const Entry entry{ searchPosition(root, 0, infinity, infinity, search) };
+
+	if (entry.proof == 0)
+	{
+		//the line gets as many nodes again as the proof took, it's mostly still in the table
+		search.nodeLimit = search.nodes * 2 + 1;
+		search.isStopped = nullptr;
+
+		result.status = Status::Mate;
+		result.line = getLine(root, search);
+	}
+	else if (entry.disproof == 0)
+	{
+		result.status = Status::NoMate;
+	}
+
+	result.nodes = search.nodes;
+
+	return result;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "zobrist.h"
+#include "move.h"
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+class Board;
+
+//forced mates for the side to move, proven by depth-first proof-number search (df-pn)
+//
+//instead of searching every line to a fixed depth, each position keeps how many more leaves would have to be
+//proven to show a mate (proof number) and to show there's none (disproof number), and the search always goes
+//down the line that is cheapest to settle. Checks, with their few replies, get settled first, so deep mates
+//take a tiny fraction of the nodes a full-width search would.
+//
+//the numbers live in a table of a fixed size, which the caller owns and can reuse from one solve to the next,
+//each solve starting as if it were empty. When it's full, the positions that took the least work to settle are replaced first, and are searched
+//again if they're needed. Draws and lines longer than maxPlies count as no mate.
+namespace MateSolver
+{
+	inline constexpr int tableSize{ 1 << 18 };			//entries, a power of two
+	inline constexpr int maxPlies{ 64 };				//deeper lines are given up as not mating
+	inline constexpr std::uint32_t infinity{ 1u << 30 };	//a settled proof or disproof number
+	inline constexpr std::uint64_t gameNodes{ 1 << 14 };	//what the game gives it alongside the AI's searches
+
+	enum class Status
+	{
+		Mate,
+		NoMate,			//proven, as far as draws and maxPlies go
+		Unknown,		//ran out of nodes first, or was stopped
+	};
+
+	struct Entry
+	{
+		Zobrist::Key key{ 0 };
+		std::uint32_t proof{ 1 };			//from the side to move, the ones to prove it gets its way, mating or escaping
+		std::uint32_t disproof{ 1 };		//and to prove it doesn't
+		std::uint32_t work{ 0 };			//nodes spent on it, to pick what gets replaced
+		std::uint16_t mateDistance{ 0 };	//plies, for the ones proven to mate or be mated
+		std::uint16_t generation{ 0 };		//of the solve that stored it, older ones count as free
+	};
+
+	static_assert(sizeof(Entry) == 24);
+
+	struct Result
+	{
+		Status status{ Status::Unknown };
+		std::vector<Move> line{};			//the mate, with the defender's longest resistance it found
+		std::uint64_t nodes{ 0 };
+	};
+
+	//allocated once, and used by one solve at a time
+	class Table
+	{
+		public:
+			Table();
+
+			void startSolve();
+			const Entry* find(Zobrist::Key key) const;		//nullptr when this solve didn't store the key, or it was replaced
+			void store(Entry entry);
+
+		private:
+			static constexpr int bucketSize{ 2 };		//slots a key can go in, the one with the least work being replaced
+
+			std::vector<Entry> m_entries{};
+			std::uint16_t m_generation{ 0 };
+
+			Entry* getBucket(Zobrist::Key key);
+			const Entry* getBucket(Zobrist::Key key) const;
+
+			Table(const Table&) = delete;
+			void operator=(const Table&) = delete;
+	};
+
+	//nodes of 0 means no limit, and the search stops early once isStopped is set
+	Result solve(const Board& board, std::uint64_t nodes, Table& table, const std::atomic<bool>* isStopped = nullptr);
+}
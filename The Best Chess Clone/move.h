@@ -0,0 +1,90 @@
+#pragma once
+#include "piece.h"
+#include <cstdint>
+#include <string>
+
+//a move packed into 16 bits: 6 for the origin square, 6 for the target square and 4 for the flags
+//
+//squares are numbered from a1 (0) to h8 (63) whatever side the player sits on, like Board::toSquare.
+//The flags follow the usual layout, so captures and promotions are each a single bit.
+//The empty move is all zeros, a1 to a1, which no piece can play.
+class Move
+{
+	public:
+
+		enum class Flag : std::uint8_t
+		{
+			Quiet,
+			DoublePawnPush,
+			KingCastle,
+			QueenCastle,
+			Capture,
+			EnPassant,
+			KnightPromotion = 8,
+			BishopPromotion,
+			RookPromotion,
+			QueenPromotion,
+			KnightPromotionCapture,
+			BishopPromotionCapture,
+			RookPromotionCapture,
+			QueenPromotionCapture,
+		};
+
+		constexpr Move() = default;
+
+		constexpr Move(int from, int to, Flag flag = Flag::Quiet)
+			: m_data{ static_cast<std::uint16_t>(from | (to << 6) | (static_cast<int>(flag) << 12)) } {}
+
+		static constexpr Move fromData(std::uint16_t data)
+		{
+			Move move{};
+			move.m_data = data;
+			return move;
+		}
+
+		constexpr int getFrom() const { return m_data & 0x3f; }
+		constexpr int getTo() const { return (m_data >> 6) & 0x3f; }
+		constexpr Flag getFlag() const { return static_cast<Flag>(m_data >> 12); }
+		constexpr std::uint16_t getData() const { return m_data; }
+
+		constexpr bool isEmpty() const { return m_data == 0; }
+		constexpr bool isCapture() const { return (m_data >> 12) & captureBit; }
+		constexpr bool isPromotion() const { return (m_data >> 12) & promotionBit; }
+		constexpr bool isEnPassant() const { return getFlag() == Flag::EnPassant; }
+		constexpr bool isCastling() const { return getFlag() == Flag::KingCastle || getFlag() == Flag::QueenCastle; }
+
+		//only meaningful for promotions, the two low flag bits go from knight to queen
+		constexpr Piece::Type getPromotionType() const { return static_cast<Piece::Type>(((m_data >> 12) & 3) + static_cast<int>(Piece::Type::Knight)); }
+
+		static constexpr Flag getPromotionFlag(Piece::Type type, bool isCapture)
+		{
+			return static_cast<Flag>(promotionBit | (isCapture ? captureBit : 0) | (static_cast<int>(type) - static_cast<int>(Piece::Type::Knight)));
+		}
+
+		constexpr bool operator==(const Move& move) const = default;
+
+		//coordinate notation, as in e2e4 or e7e8q
+		std::string toString() const
+		{
+			std::string text{ getSquareName(getFrom()) + getSquareName(getTo()) };
+
+			if (isPromotion())
+				text += Piece::getLetter(getPromotionType(), Piece::Color::White);
+
+			return text;
+		}
+
+		static std::string getSquareName(int square)
+		{
+			return { static_cast<char>('a' + square % 8), static_cast<char>('1' + square / 8) };
+		}
+
+	private:
+
+		static constexpr int captureBit{ 4 };
+		static constexpr int promotionBit{ 8 };
+
+		std::uint16_t m_data{ 0 };
+};
+
+static_assert(sizeof(Move) == 2);
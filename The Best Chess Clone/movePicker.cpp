@@ -0,0 +1,155 @@
+#include "movePicker.h"
+#include "board.h"
+#include "move.h"
+#include "piece.h"
+#include "evalParams.h"
+#include "constants.h"
+#include "trace.h"
+#include "allocTracking.h"
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+
+MovePicker::MovePicker(const Board& board, Piece::Color color, Move transpositionMove, const Killers& killers, const History& history)
+	: m_board{ board }, m_color{ color }, m_transpositionMove{ transpositionMove }, m_killers{ killers }, m_history{ history } {}
+
+Move MovePicker::next()
+{
+	ALLOC_SCOPE("MovePicker::next");
+
+	while (true)
+	{
+		switch (m_stage)
+		{
+			case Stage::TranspositionMove:
+				m_stage = Stage::GenerateCaptures;
+
+				//the table can hold a move from another position with the same slot, or a colliding key
+				if (!m_transpositionMove.isEmpty() && m_board.isPlayableMove(m_transpositionMove, m_color))
+					return m_transpositionMove;
+
+				m_transpositionMove = Move{};
+				break;
+
+			case Stage::GenerateCaptures:
+				generateCaptures();
+				m_stage = Stage::WinningCaptures;
+				break;
+
+			case Stage::WinningCaptures:
+				while (m_index < m_moves.size())
+				{
+					const Move move{ m_moves[m_index++].move };
+
+					if (!isPicked(move))
+						return move;
+				}
+
+				m_index = 0;
+				m_stage = Stage::Killers;
+				break;
+
+			//killers come from sibling positions, where they may not even be legal
+			case Stage::Killers:
+				while (m_index < m_killers.size())
+				{
+					const Move move{ m_killers[m_index++] };
+
+					if (!move.isEmpty() && move != m_transpositionMove && m_board.isPlayableMove(move, m_color))
+						return move;
+				}
+
+				m_stage = Stage::GenerateQuiets;
+				break;
+
+			case Stage::GenerateQuiets:
+				generateQuiets();
+				m_stage = Stage::Quiets;
+				break;
+
+			case Stage::Quiets:
+				while (m_index < m_moves.size())
+				{
+					const Move move{ m_moves[m_index++].move };
+
+					if (!isPicked(move))
+						return move;
+				}
+
+				m_moves = std::move(m_losingCaptures);
+				m_index = 0;
+				m_stage = Stage::LosingCaptures;
+				break;
+
+			case Stage::LosingCaptures:
+				while (m_index < m_moves.size())
+				{
+					const Move move{ m_moves[m_index++].move };
+
+					if (!isPicked(move))
+						return move;
+				}
+
+				m_stage = Stage::Done;
+				break;
+
+			case Stage::Done:
+				return Move{};
+		}
+	}
+}
+
+MovePicker::Stage MovePicker::getStage() const
+{
+	return m_stage;
+}
+
+std::size_t MovePicker::getHistoryIndex(Piece::Color color, Move move)
+{
+	return (static_cast<std::size_t>(color) * Constants::array2dSize + static_cast<std::size_t>(move.getFrom())) * Constants::array2dSize + static_cast<std::size_t>(move.getTo());
+}
+
+//most valuable victim first, then least valuable attacker. Taking a cheaper piece on a defended square loses material
+void MovePicker::generateCaptures()
+{
+	TRACE_SCOPE("MovePicker::generateCaptures");
+
+	const auto getValue{ [](Piece::Type type) { return EvalParams::pieceValues[static_cast<std::size_t>(type)]; } };
+
+	for (const Move move : m_board.generateCaptures(m_color))
+	{
+		const Coordinates target{ m_board.toCoordinates(move.getTo()) };
+		const int attacker{ getValue(Piece::getType(m_board(m_board.toCoordinates(move.getFrom())))) };
+		const int victim{ move.isEnPassant() ? getValue(Piece::Type::Pawn) : getValue(Piece::getType(m_board(target))) };
+		const ScoredMove scoredMove{ move, victim * Constants::squaresPerLine - attacker };
+
+		if (victim >= attacker || !m_board.isAttackedBy(target, !m_color))
+			m_moves.push_back(scoredMove);
+		else
+			m_losingCaptures.push_back(scoredMove);
+	}
+
+	const auto isBetter{ [](const ScoredMove& first, const ScoredMove& second) { return first.score > second.score; } };
+
+	std::stable_sort(m_moves.begin(), m_moves.end(), isBetter);
+	std::stable_sort(m_losingCaptures.begin(), m_losingCaptures.end(), isBetter);
+}
+
+//ties keep the generation order, so the search stays the same from one run to the next
+void MovePicker::generateQuiets()
+{
+	TRACE_SCOPE("MovePicker::generateQuiets");
+
+	m_moves.clear();
+	m_index = 0;
+
+	for (const Move move : m_board.generateQuiets(m_color))
+		m_moves.push_back({ move, m_history[getHistoryIndex(m_color, move)] });
+
+	std::stable_sort(m_moves.begin(), m_moves.end(), [](const ScoredMove& first, const ScoredMove& second) { return first.score > second.score; });
+}
+
+bool MovePicker::isPicked(Move move) const
+{
+	return move == m_transpositionMove || move == m_killers[0] || move == m_killers[1];
+}
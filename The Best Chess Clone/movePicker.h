@@ -0,0 +1,67 @@
+#pragma once
+#include "move.h"
+#include "piece.h"
+#include "constants.h"
+#include <array>
+#include <vector>
+#include <cstddef>
+
+class Board;
+
+//hands out a search node's moves a stage at a time: the transposition table's move, captures that win
+//material, the killers, the quiet moves by history and then the captures that lose material
+//
+//each stage is only generated once the previous one is used up, so a node cut off by one of its
+//first moves never pays for the quiet moves
+class MovePicker
+{
+	public:
+
+		enum class Stage
+		{
+			TranspositionMove,
+			GenerateCaptures,
+			WinningCaptures,
+			Killers,
+			GenerateQuiets,
+			Quiets,
+			LosingCaptures,
+			Done,
+		};
+
+		using Killers = std::array<Move, 2>;		//quiet moves that cut off a sibling node, newest first
+		using History = std::vector<int>;			//by color, origin and target square, see getHistoryIndex
+
+		static constexpr std::size_t historySize{ 2 * Constants::array2dSize * Constants::array2dSize };
+
+		MovePicker(const Board& board, Piece::Color color, Move transpositionMove, const Killers& killers, const History& history);
+
+		//the empty move once every stage is used up
+		Move next();
+		Stage getStage() const;
+
+		static std::size_t getHistoryIndex(Piece::Color color, Move move);
+
+	private:
+
+		struct ScoredMove
+		{
+			Move move{};
+			int score{ 0 };
+		};
+
+		const Board& m_board;
+		Piece::Color m_color{};
+		Move m_transpositionMove{};
+		const Killers& m_killers;
+		const History& m_history;
+
+		Stage m_stage{ Stage::TranspositionMove };
+		std::vector<ScoredMove> m_moves{};			//of the current stage, best first
+		std::vector<ScoredMove> m_losingCaptures{};
+		std::size_t m_index{ 0 };
+
+		void generateCaptures();
+		void generateQuiets();
+		bool isPicked(Move move) const;
+};
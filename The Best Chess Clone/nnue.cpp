@@ -0,0 +1,484 @@
+#include "nnue.h"
+#include "mappedFile.h"
+#include "piece.h"
+#include <string_view>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <bit>
+
+#if defined(__AVX2__)
+	#define NNUE_USE_AVX2
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define NNUE_USE_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace
+{
+	constexpr std::string_view magic{ "BCCNNUE1" };
+	constexpr std::size_t headerSize{ 32 };
+	constexpr int transformedSize{ Nnue::accumulatorSize * 2 };
+	constexpr int maxActivation{ 127 };
+	constexpr int chunkSize{ 4 };				//inputs of the first layer skipped together when they're all zero
+	constexpr int chunkCount{ transformedSize / chunkSize };
+	constexpr int chunkWeights{ Nnue::hiddenSize * chunkSize };
+
+	struct Network
+	{
+		const std::int16_t* featureBiases{ nullptr };
+		const std::int16_t* featureWeights{ nullptr };
+		const std::int32_t* hidden1Biases{ nullptr };
+		const std::int8_t* hidden1Weights{ nullptr };
+		const std::int32_t* hidden2Biases{ nullptr };
+		const std::int8_t* hidden2Weights{ nullptr };
+		const std::int32_t* outputBias{ nullptr };
+		const std::int8_t* outputWeights{ nullptr };
+	};
+
+	MappedFile s_file{};
+	Network s_network{};
+	bool s_isLoaded{ false };
+
+#if defined(NNUE_USE_SSE2)
+	using ChunkWeight = std::int16_t;		//without a byte multiply, they're widened once on load instead of on every evaluation
+#else
+	using ChunkWeight = std::int8_t;
+#endif
+
+	//the first layer's weights regrouped by chunk, each holding the chunk's four weights for every output in turn
+	alignas(32) std::array<ChunkWeight, chunkCount * chunkWeights> s_chunkWeights{};
+
+	std::uint32_t readUInt32(std::span<const std::byte> data, std::size_t offset)
+	{
+		std::uint32_t value{};
+		std::memcpy(&value, data.data() + offset, sizeof(value));
+		return value;
+	}
+
+	template <typename T>
+	const T* takeArray(std::span<const std::byte> data, std::size_t& offset, std::size_t count)
+	{
+		const T* array{ reinterpret_cast<const T*>(data.data() + offset) };
+		offset += count * sizeof(T);
+		return array;
+	}
+
+	void addColumn(std::int16_t* values, const std::int16_t* column)
+	{
+#if defined(NNUE_USE_AVX2)
+		for (int i{ 0 }; i < Nnue::accumulatorSize; i += 16)
+		{
+			__m256i* target{ reinterpret_cast<__m256i*>(values + i) };
+			const __m256i weights{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i)) };
+			_mm256_store_si256(target, _mm256_add_epi16(_mm256_load_si256(target), weights));
+		}
+#elif defined(NNUE_USE_SSE2)
+		for (int i{ 0 }; i < Nnue::accumulatorSize; i += 8)
+		{
+			__m128i* target{ reinterpret_cast<__m128i*>(values + i) };
+			const __m128i weights{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i)) };
+			_mm_store_si128(target, _mm_add_epi16(_mm_load_si128(target), weights));
+		}
+#else
+		for (int i{ 0 }; i < Nnue::accumulatorSize; ++i)
+			values[i] = static_cast<std::int16_t>(values[i] + column[i]);
+#endif
+	}
+
+	void subtractColumn(std::int16_t* values, const std::int16_t* column)
+	{
+#if defined(NNUE_USE_AVX2)
+		for (int i{ 0 }; i < Nnue::accumulatorSize; i += 16)
+		{
+			__m256i* target{ reinterpret_cast<__m256i*>(values + i) };
+			const __m256i weights{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i)) };
+			_mm256_store_si256(target, _mm256_sub_epi16(_mm256_load_si256(target), weights));
+		}
+#elif defined(NNUE_USE_SSE2)
+		for (int i{ 0 }; i < Nnue::accumulatorSize; i += 8)
+		{
+			__m128i* target{ reinterpret_cast<__m128i*>(values + i) };
+			const __m128i weights{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i)) };
+			_mm_store_si128(target, _mm_sub_epi16(_mm_load_si128(target), weights));
+		}
+#else
+		for (int i{ 0 }; i < Nnue::accumulatorSize; ++i)
+			values[i] = static_cast<std::int16_t>(values[i] - column[i]);
+#endif
+	}
+
+	//clamps a perspective of the accumulator to [0, 127] and packs it into bytes
+	void transform(const std::int16_t* values, std::uint8_t* output)
+	{
+#if defined(NNUE_USE_AVX2)
+		const __m256i zero{ _mm256_setzero_si256() };
+
+		for (int i{ 0 }; i < Nnue::accumulatorSize; i += 32)
+		{
+			const __m256i low{ _mm256_max_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(values + i)), zero) };
+			const __m256i high{ _mm256_max_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(values + i + 16)), zero) };
+			const __m256i packed{ _mm256_permute4x64_epi64(_mm256_packs_epi16(low, high), 0b11011000) };
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), packed);
+		}
+#elif defined(NNUE_USE_SSE2)
+		const __m128i zero{ _mm_setzero_si128() };
+
+		for (int i{ 0 }; i < Nnue::accumulatorSize; i += 16)
+		{
+			const __m128i low{ _mm_max_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(values + i)), zero) };
+			const __m128i high{ _mm_max_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(values + i + 8)), zero) };
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_packs_epi16(low, high));
+		}
+#else
+		for (int i{ 0 }; i < Nnue::accumulatorSize; ++i)
+			output[i] = static_cast<std::uint8_t>(std::clamp<int>(values[i], 0, maxActivation));
+#endif
+	}
+
+	std::int32_t dotProduct(const std::uint8_t* input, const std::int8_t* weights, int size)
+	{
+#if defined(NNUE_USE_AVX2)
+		const __m256i ones{ _mm256_set1_epi16(1) };
+		__m256i sum{ _mm256_setzero_si256() };
+
+		for (int i{ 0 }; i < size; i += 32)
+		{
+			const __m256i in{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i)) };
+			const __m256i weight{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i)) };
+			sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(in, weight), ones));
+		}
+
+		__m128i half{ _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)) };
+		half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0b01001110));
+		half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0b10110001));
+		return _mm_cvtsi128_si32(half);
+#elif defined(NNUE_USE_SSE2)
+		const __m128i zero{ _mm_setzero_si128() };
+		__m128i sum{ _mm_setzero_si128() };
+
+		for (int i{ 0 }; i < size; i += 16)
+		{
+			const __m128i in{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)) };
+			const __m128i weight{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i)) };
+
+			//inputs are zero extended and weights sign extended to 16 bits
+			const __m128i inLow{ _mm_unpacklo_epi8(in, zero) };
+			const __m128i inHigh{ _mm_unpackhi_epi8(in, zero) };
+			const __m128i weightLow{ _mm_srai_epi16(_mm_unpacklo_epi8(weight, weight), 8) };
+			const __m128i weightHigh{ _mm_srai_epi16(_mm_unpackhi_epi8(weight, weight), 8) };
+
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(inLow, weightLow));
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(inHigh, weightHigh));
+		}
+
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0b01001110));
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0b10110001));
+		return _mm_cvtsi128_si32(sum);
+#else
+		std::int32_t sum{ 0 };
+
+		for (int i{ 0 }; i < size; ++i)
+			sum += static_cast<std::int32_t>(input[i]) * weights[i];
+
+		return sum;
+#endif
+	}
+
+	//four output rows are computed together so the horizontal sums are shared between them
+	void affine(const std::uint8_t* input, int inputSize, const std::int32_t* biases, const std::int8_t* weights, std::uint8_t* output)
+	{
+		constexpr int rowsPerStep{ 4 };
+
+		for (int row{ 0 }; row < Nnue::hiddenSize; row += rowsPerStep)
+		{
+			const std::int8_t* rowWeights{ weights + row * inputSize };
+			std::array<std::int32_t, rowsPerStep> sums{};
+
+#if defined(NNUE_USE_AVX2)
+			const __m256i ones{ _mm256_set1_epi16(1) };
+			__m256i rowSums[rowsPerStep]{ _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256() };
+
+			for (int i{ 0 }; i < inputSize; i += 32)
+			{
+				const __m256i in{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i)) };
+
+				for (int j{ 0 }; j < rowsPerStep; ++j)
+				{
+					const __m256i weight{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowWeights + j * inputSize + i)) };
+					rowSums[j] = _mm256_add_epi32(rowSums[j], _mm256_madd_epi16(_mm256_maddubs_epi16(in, weight), ones));
+				}
+			}
+
+			const __m256i pairs{ _mm256_hadd_epi32(_mm256_hadd_epi32(rowSums[0], rowSums[1]), _mm256_hadd_epi32(rowSums[2], rowSums[3])) };
+			const __m128i reduced{ _mm_add_epi32(_mm256_castsi256_si128(pairs), _mm256_extracti128_si256(pairs, 1)) };
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(sums.data()), reduced);
+#elif defined(NNUE_USE_SSE2)
+			const __m128i zero{ _mm_setzero_si128() };
+			__m128i rowSums[rowsPerStep]{ zero, zero, zero, zero };
+
+			for (int i{ 0 }; i < inputSize; i += 16)
+			{
+				const __m128i in{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)) };
+				const __m128i inLow{ _mm_unpacklo_epi8(in, zero) };
+				const __m128i inHigh{ _mm_unpackhi_epi8(in, zero) };
+
+				for (int j{ 0 }; j < rowsPerStep; ++j)
+				{
+					//inputs are zero extended and weights sign extended to 16 bits
+					const __m128i weight{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(rowWeights + j * inputSize + i)) };
+					const __m128i weightLow{ _mm_srai_epi16(_mm_unpacklo_epi8(weight, weight), 8) };
+					const __m128i weightHigh{ _mm_srai_epi16(_mm_unpackhi_epi8(weight, weight), 8) };
+
+					rowSums[j] = _mm_add_epi32(rowSums[j], _mm_madd_epi16(inLow, weightLow));
+					rowSums[j] = _mm_add_epi32(rowSums[j], _mm_madd_epi16(inHigh, weightHigh));
+				}
+			}
+
+			//transposes the four partial sums so each lane ends up with a whole row
+			const __m128i sums01{ _mm_add_epi32(_mm_unpacklo_epi32(rowSums[0], rowSums[1]), _mm_unpackhi_epi32(rowSums[0], rowSums[1])) };
+			const __m128i sums23{ _mm_add_epi32(_mm_unpacklo_epi32(rowSums[2], rowSums[3]), _mm_unpackhi_epi32(rowSums[2], rowSums[3])) };
+			const __m128i reduced{ _mm_add_epi32(_mm_unpacklo_epi64(sums01, sums23), _mm_unpackhi_epi64(sums01, sums23)) };
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(sums.data()), reduced);
+#else
+			for (int j{ 0 }; j < rowsPerStep; ++j)
+				for (int i{ 0 }; i < inputSize; ++i)
+					sums[static_cast<size_t>(j)] += static_cast<std::int32_t>(input[i]) * rowWeights[j * inputSize + i];
+#endif
+
+			for (int j{ 0 }; j < rowsPerStep; ++j)
+			{
+				const std::int32_t sum{ biases[row + j] + sums[static_cast<size_t>(j)] };
+				output[row + j] = static_cast<std::uint8_t>(std::clamp(sum >> Nnue::weightScaleBits, 0, maxActivation));
+			}
+		}
+	}
+	//indices of the chunks with any input above zero, which after the clamp is about half of them
+	int findNonZeroChunks(const std::uint8_t* input, std::array<std::uint16_t, chunkCount>& chunks)
+	{
+		int count{ 0 };
+
+#if defined(NNUE_USE_AVX2)
+		const __m256i zero{ _mm256_setzero_si256() };
+
+		for (int i{ 0 }; i < transformedSize; i += 32)
+		{
+			const __m256i zeroChunks{ _mm256_cmpeq_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(input + i)), zero) };
+
+			for (auto mask{ ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(zeroChunks))) & 0xFFu }; mask != 0; mask &= mask - 1)
+				chunks[static_cast<size_t>(count++)] = static_cast<std::uint16_t>(i / chunkSize + std::countr_zero(mask));
+		}
+#elif defined(NNUE_USE_SSE2)
+		const __m128i zero{ _mm_setzero_si128() };
+
+		for (int i{ 0 }; i < transformedSize; i += 16)
+		{
+			const __m128i zeroChunks{ _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(input + i)), zero) };
+
+			for (auto mask{ ~static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(zeroChunks))) & 0xFu }; mask != 0; mask &= mask - 1)
+				chunks[static_cast<size_t>(count++)] = static_cast<std::uint16_t>(i / chunkSize + std::countr_zero(mask));
+		}
+#else
+		for (int i{ 0 }; i < chunkCount; ++i)
+		{
+			std::uint32_t chunk{};
+			std::memcpy(&chunk, input + i * chunkSize, sizeof(chunk));
+
+			if (chunk != 0)
+				chunks[static_cast<size_t>(count++)] = static_cast<std::uint16_t>(i);
+		}
+#endif
+
+		return count;
+	}
+
+	//the first layer, going over the non-zero chunks only. The sums are the same as over every input, just added up in another order
+	void affineSparse(const std::uint8_t* input, const std::int32_t* biases, std::uint8_t* output)
+	{
+		std::array<std::uint16_t, chunkCount> chunks{};
+		const int nonZeroChunks{ findNonZeroChunks(input, chunks) };
+		alignas(32) std::array<std::int32_t, Nnue::hiddenSize> sums{};
+
+#if defined(NNUE_USE_AVX2)
+		constexpr int registers{ Nnue::hiddenSize / 8 };
+		const __m256i ones{ _mm256_set1_epi16(1) };
+		__m256i rowSums[registers]{ _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256() };
+
+		for (int i{ 0 }; i < nonZeroChunks; ++i)
+		{
+			const int chunk{ chunks[static_cast<size_t>(i)] };
+			const ChunkWeight* weights{ s_chunkWeights.data() + chunk * chunkWeights };
+			std::int32_t inputs{};
+			std::memcpy(&inputs, input + chunk * chunkSize, sizeof(inputs));
+
+			const __m256i in{ _mm256_set1_epi32(inputs) };
+
+			for (int j{ 0 }; j < registers; ++j)
+			{
+				const __m256i weight{ _mm256_load_si256(reinterpret_cast<const __m256i*>(weights + j * 32)) };
+				rowSums[j] = _mm256_add_epi32(rowSums[j], _mm256_madd_epi16(_mm256_maddubs_epi16(in, weight), ones));
+			}
+		}
+
+		for (int j{ 0 }; j < registers; ++j)
+			_mm256_store_si256(reinterpret_cast<__m256i*>(sums.data() + j * 8), rowSums[j]);
+#elif defined(NNUE_USE_SSE2)
+		//every lane sums half a chunk for one output, the two halves being added together at the end. The outputs
+		//are gone over in two goes, so the sums stay in registers
+		constexpr int passes{ 2 };
+		constexpr int registers{ Nnue::hiddenSize / passes / 2 };
+		const __m128i zero{ _mm_setzero_si128() };
+		alignas(16) std::array<std::int32_t, Nnue::hiddenSize * 2> halfSums{};
+
+		for (int pass{ 0 }; pass < passes; ++pass)
+		{
+			__m128i rowSums[registers]{};
+
+			for (int i{ 0 }; i < nonZeroChunks; ++i)
+			{
+				const int chunk{ chunks[static_cast<size_t>(i)] };
+				const ChunkWeight* weights{ s_chunkWeights.data() + chunk * chunkWeights + pass * chunkWeights / passes };
+				std::int32_t inputs{};
+				std::memcpy(&inputs, input + chunk * chunkSize, sizeof(inputs));
+
+				//the chunk zero extended to 16 bits, twice over to cover two outputs
+				const __m128i in{ _mm_unpacklo_epi8(_mm_set1_epi32(inputs), zero) };
+
+				for (int j{ 0 }; j < registers; ++j)
+					rowSums[j] = _mm_add_epi32(rowSums[j], _mm_madd_epi16(in, _mm_load_si128(reinterpret_cast<const __m128i*>(weights + j * 8))));
+			}
+
+			for (int j{ 0 }; j < registers; ++j)
+				_mm_store_si128(reinterpret_cast<__m128i*>(halfSums.data() + (pass * registers + j) * 4), rowSums[j]);
+		}
+
+		for (int j{ 0 }; j < Nnue::hiddenSize; ++j)
+			sums[static_cast<size_t>(j)] = halfSums[static_cast<size_t>(j * 2)] + halfSums[static_cast<size_t>(j * 2 + 1)];
+#else
+		for (int i{ 0 }; i < nonZeroChunks; ++i)
+		{
+			const int chunk{ chunks[static_cast<size_t>(i)] };
+			const ChunkWeight* weights{ s_chunkWeights.data() + chunk * chunkWeights };
+
+			for (int j{ 0 }; j < Nnue::hiddenSize; ++j)
+				for (int k{ 0 }; k < chunkSize; ++k)
+					sums[static_cast<size_t>(j)] += static_cast<std::int32_t>(input[chunk * chunkSize + k]) * weights[j * chunkSize + k];
+		}
+#endif
+
+		for (int j{ 0 }; j < Nnue::hiddenSize; ++j)
+			output[j] = static_cast<std::uint8_t>(std::clamp((biases[j] + sums[static_cast<size_t>(j)]) >> Nnue::weightScaleBits, 0, maxActivation));
+	}
+}
+
+bool Nnue::load(std::string_view path)
+{
+	MappedFile file{};
+
+	if (!file.open(path))
+		return false;
+
+	const auto data{ file.getData() };
+
+	const std::size_t expectedSize
+	{
+		headerSize +
+		sizeof(std::int16_t) * (accumulatorSize + static_cast<std::size_t>(inputs) * accumulatorSize) +
+		sizeof(std::int32_t) * hiddenSize + sizeof(std::int8_t) * hiddenSize * transformedSize +
+		sizeof(std::int32_t) * hiddenSize + sizeof(std::int8_t) * hiddenSize * hiddenSize +
+		sizeof(std::int32_t) + sizeof(std::int8_t) * hiddenSize
+	};
+
+	if	(
+			data.size() != expectedSize ||
+			std::memcmp(data.data(), magic.data(), magic.size()) != 0 ||
+			readUInt32(data, 8) != version ||
+			readUInt32(data, 12) != inputs ||
+			readUInt32(data, 16) != accumulatorSize ||
+			readUInt32(data, 20) != hiddenSize
+		)
+	{
+		return false;
+	}
+
+	std::size_t offset{ headerSize };
+	Network network{};
+
+	network.featureBiases = takeArray<std::int16_t>(data, offset, accumulatorSize);
+	network.featureWeights = takeArray<std::int16_t>(data, offset, static_cast<std::size_t>(inputs) * accumulatorSize);
+	network.hidden1Biases = takeArray<std::int32_t>(data, offset, hiddenSize);
+	network.hidden1Weights = takeArray<std::int8_t>(data, offset, hiddenSize * transformedSize);
+	network.hidden2Biases = takeArray<std::int32_t>(data, offset, hiddenSize);
+	network.hidden2Weights = takeArray<std::int8_t>(data, offset, hiddenSize * hiddenSize);
+	network.outputBias = takeArray<std::int32_t>(data, offset, 1);
+	network.outputWeights = takeArray<std::int8_t>(data, offset, hiddenSize);
+
+	for (int chunk{ 0 }; chunk < chunkCount; ++chunk)
+		for (int row{ 0 }; row < hiddenSize; ++row)
+			std::copy_n(network.hidden1Weights + row * transformedSize + chunk * chunkSize, chunkSize, s_chunkWeights.begin() + chunk * chunkWeights + row * chunkSize);
+
+	s_file = std::move(file);
+	s_network = network;
+	s_isLoaded = true;
+
+	return true;
+}
+
+bool Nnue::isLoaded()
+{
+	return s_isLoaded;
+}
+
+int Nnue::getFeatureIndex(Piece::Color perspective, int kingSquare, char letter, int square)
+{
+	constexpr int flipRanks{ 56 };
+	constexpr int kindsPerColor{ pieceKinds / 2 };
+
+	if (perspective == Piece::Color::Black)
+	{
+		kingSquare ^= flipRanks;
+		square ^= flipRanks;
+	}
+
+	const int kind{ static_cast<int>(Piece::getType(letter)) + ((Piece::getColor(letter) == perspective) ? 0 : kindsPerColor) };
+
+	return (kingSquare * pieceKinds + kind) * squares + square;
+}
+
+void Nnue::clear(Accumulator& accumulator, Piece::Color perspective)
+{
+	const auto side{ static_cast<std::size_t>(perspective) };
+	std::copy_n(s_network.featureBiases, accumulatorSize, accumulator.values[side].begin());
+	accumulator.isDirty[side] = false;
+}
+
+void Nnue::addFeature(Accumulator& accumulator, Piece::Color perspective, int feature)
+{
+	addColumn(accumulator.values[static_cast<std::size_t>(perspective)].data(), s_network.featureWeights + static_cast<std::size_t>(feature) * accumulatorSize);
+}
+
+void Nnue::removeFeature(Accumulator& accumulator, Piece::Color perspective, int feature)
+{
+	subtractColumn(accumulator.values[static_cast<std::size_t>(perspective)].data(), s_network.featureWeights + static_cast<std::size_t>(feature) * accumulatorSize);
+}
+
+int Nnue::evaluate(const Accumulator& accumulator, Piece::Color sideToMove)
+{
+	alignas(32) std::array<std::uint8_t, transformedSize> transformed{};
+	alignas(32) std::array<std::uint8_t, hiddenSize> hidden1{};
+	alignas(32) std::array<std::uint8_t, hiddenSize> hidden2{};
+
+	transform(accumulator.values[static_cast<std::size_t>(sideToMove)].data(), transformed.data());
+	transform(accumulator.values[static_cast<std::size_t>(!sideToMove)].data(), transformed.data() + accumulatorSize);
+
+	affineSparse(transformed.data(), s_network.hidden1Biases, hidden1.data());
+	affine(hidden1.data(), hiddenSize, s_network.hidden2Biases, s_network.hidden2Weights, hidden2.data());
+
+	const std::int32_t output{ *s_network.outputBias + dotProduct(hidden2.data(), s_network.outputWeights, hiddenSize) };
+
+	return output / outputScale;
+}
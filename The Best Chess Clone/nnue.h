@@ -0,0 +1,47 @@
+#pragma once
+#include "piece.h"
+#include <string_view>
+#include <array>
+#include <cstdint>
+
+//optional neural network evaluation (HalfKP features -> 2x256 -> 32 -> 32 -> 1)
+//
+//the weights file is memory-mapped and read in place, but for the first hidden layer's weights, which are regrouped
+//on load so the inputs clamped to zero can be skipped. All values are little-endian:
+//	header			"BCCNNUE1", then uint32 version, inputs, accumulatorSize, hiddenSize and 8 padding bytes
+//	int16			featureBiases[accumulatorSize]
+//	int16			featureWeights[inputs][accumulatorSize]
+//	int32			hidden1Biases[hiddenSize]
+//	int8			hidden1Weights[hiddenSize][accumulatorSize * 2]
+//	int32			hidden2Biases[hiddenSize]
+//	int8			hidden2Weights[hiddenSize][hiddenSize]
+//	int32			outputBias
+//	int8			outputWeights[hiddenSize]
+namespace Nnue
+{
+	inline constexpr std::uint32_t version{ 1 };
+	inline constexpr int squares{ 64 };
+	inline constexpr int pieceKinds{ 10 };				//own and rival pawn, knight, bishop, rook and queen
+	inline constexpr int inputs{ squares * pieceKinds * squares };
+	inline constexpr int accumulatorSize{ 256 };
+	inline constexpr int hiddenSize{ 32 };
+	inline constexpr int weightScaleBits{ 6 };
+	inline constexpr int outputScale{ 16 };
+
+	//first layer output for both perspectives, updated incrementally by the board
+	struct alignas(32) Accumulator
+	{
+		std::array<std::array<std::int16_t, accumulatorSize>, 2> values{};
+		std::array<bool, 2> isDirty{ true, true };		//a king move forces a refresh of its own perspective
+	};
+
+	bool load(std::string_view path);
+	bool isLoaded();
+
+	//squares are numbered from white's side, a1 = 0
+	int getFeatureIndex(Piece::Color perspective, int kingSquare, char letter, int square);
+	void clear(Accumulator& accumulator, Piece::Color perspective);
+	void addFeature(Accumulator& accumulator, Piece::Color perspective, int feature);
+	void removeFeature(Accumulator& accumulator, Piece::Color perspective, int feature);
+	int evaluate(const Accumulator& accumulator, Piece::Color sideToMove);
+}
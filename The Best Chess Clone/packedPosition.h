@@ -0,0 +1,46 @@
+#pragma once
+#include "piece.h"
+#include <array>
+#include <cstdint>
+
+//a whole position in 32 bytes, for scoring or storing large sets of them
+//
+//occupancy has a bit per square, a1 = bit 0 to h8 = bit 63, and the pieces on the occupied squares follow
+//in square order, a nibble each (low nibble first): the piece's type plus one, with 8 added for black.
+//Score, result and move are free for whoever produces the positions, the board leaves them empty.
+struct PackedPosition
+{
+	static constexpr std::uint8_t blackToMove{ 1 };
+	static constexpr std::array<std::uint8_t, 4> castlingRights{ 2, 4, 8, 16 };	//K, Q, k and q, in FEN order
+	static constexpr std::uint8_t noEnPassant{ 64 };
+	static constexpr int blackBit{ 8 };
+
+	std::uint64_t occupancy{ 0 };
+	std::array<std::uint8_t, 16> pieces{};
+	std::uint8_t state{ 0 };						//side to move and castling rights
+	std::uint8_t enPassant{ noEnPassant };			//target square
+	std::uint8_t halfmoveClock{ 0 };
+	std::int8_t result{ 0 };
+	std::int16_t score{ 0 };
+	std::uint16_t move{ 0 };						//as in Move::getData
+
+	static constexpr int getCode(Piece::Type type, Piece::Color color)
+	{
+		return static_cast<int>(type) + 1 + ((color == Piece::Color::Black) ? blackBit : 0);
+	}
+
+	//index counts occupied squares, not squares
+	constexpr int getCode(int index) const
+	{
+		return (pieces[static_cast<size_t>(index / 2)] >> (index % 2 * 4)) & 0xf;
+	}
+
+	constexpr void setCode(int index, int code)
+	{
+		std::uint8_t& pair{ pieces[static_cast<size_t>(index / 2)] };
+		const int shift{ index % 2 * 4 };
+		pair = static_cast<std::uint8_t>((pair & ~(0xf << shift)) | (code << shift));
+	}
+};
+
+static_assert(sizeof(PackedPosition) == 32);
@@ -0,0 +1,171 @@
+#include "pawns.h"
+#include "piece.h"
+#include "zobrist.h"
+#include "evalParams.h"
+#include "constants.h"
+#include "allocTracking.h"
+#include <array>
+#include <vector>
+#include <bit>
+#include <cstdint>
+
+namespace
+{
+	constexpr int lines{ Constants::squaresPerLine };
+	constexpr std::uint64_t fileA{ 0x0101010101010101ull };
+	constexpr std::uint64_t fileH{ fileA << (lines - 1) };
+	constexpr std::array<int, 8> threeBitCounts{ 0, 1, 1, 2, 1, 2, 2, 3 };
+
+	thread_local Pawns::Stats s_stats{};
+
+	//allocated on a thread's first probe, threads that never evaluate don't pay for one
+	std::vector<Pawns::Entry>& getTable()
+	{
+		ALLOC_SCOPE("Pawns::getTable");		//a thread's first probe, allowed inside the forbidden scopes
+		thread_local std::vector<Pawns::Entry> table(static_cast<size_t>(Pawns::tableSize));
+		return table;
+	}
+
+	constexpr int getRelativeRank(int rank, Piece::Color color)
+	{
+		return (color == Piece::Color::White) ? rank : lines - 1 - rank;
+	}
+
+	//every square a step forward, as the color's pawns go
+	constexpr std::uint64_t getForward(std::uint64_t squares, Piece::Color color)
+	{
+		return (color == Piece::Color::White) ? squares << lines : squares >> lines;
+	}
+
+	constexpr std::uint64_t getSideways(std::uint64_t squares)
+	{
+		return ((squares & ~fileA) >> 1) | ((squares & ~fileH) << 1);
+	}
+
+	//the squares themselves and all the ones in front of them
+	constexpr std::uint64_t getForwardFill(std::uint64_t squares, Piece::Color color)
+	{
+		for (int shift{ lines }; shift < Constants::array2dSize; shift *= 2)
+			squares |= (color == Piece::Color::White) ? squares << shift : squares >> shift;
+
+		return squares;
+	}
+
+	//whole sets at once rather than a pawn at a time, the loop's branches would depend on the pawns
+	int evaluateStructure(std::uint64_t own, std::uint64_t rival, Piece::Color color)
+	{
+		const std::uint64_t ownFiles{ getForwardFill(getForwardFill(own, color), !color) };
+		const std::uint64_t rivalSpan{ getForwardFill(getForward(rival, !color), !color) };
+		const std::uint64_t rivalAttacks{ getSideways(getForward(rival, !color)) };
+
+		//every pawn of a file but the front one counts as doubled, and only that one can be passed
+		const std::uint64_t doubled{ own & getForwardFill(getForward(own, !color), !color) };
+		const std::uint64_t isolated{ own & ~getSideways(ownFiles) };
+		const std::uint64_t passed{ own & ~doubled & ~(rivalSpan | getSideways(rivalSpan)) };
+
+		//backward has all its neighbours ahead of it, and a rival pawn keeping it from catching up
+		const std::uint64_t backward{ own & ~isolated & ~getSideways(getForwardFill(own, color)) & getForward(rivalAttacks, !color) };
+
+		int eval
+		{
+			-std::popcount(doubled) * EvalParams::doubledPawnPenalty
+			- std::popcount(isolated) * EvalParams::isolatedPawnPenalty
+			- std::popcount(backward) * EvalParams::backwardPawnPenalty
+		};
+
+		for (std::uint64_t pawns{ passed }; pawns != 0; pawns &= pawns - 1)
+			eval += EvalParams::passedPawnBonus[static_cast<size_t>(getRelativeRank(std::countr_zero(pawns) / lines, color))];
+
+		return eval;
+	}
+}
+
+double Pawns::Stats::getHitRate() const
+{
+	return (probes > 0) ? static_cast<double>(hits) / static_cast<double>(probes) : 0.0;
+}
+
+Pawns::Entry Pawns::evaluate(const Bitboards& pawns)
+{
+	Entry entry{};
+	int structure{ 0 };
+
+	for (const auto color : { Piece::Color::White, Piece::Color::Black })
+	{
+		const std::uint64_t own{ pawns[static_cast<size_t>(color)] };
+		const int eval{ evaluateStructure(own, pawns[static_cast<size_t>(!color)], color) };
+
+		structure += (color == Piece::Color::White) ? eval : -eval;
+
+		for (int file{ 0 }; file < lines; ++file)
+		{
+			int shield{ 0 };
+
+			for (int rank{ 1 }; rank <= static_cast<int>(EvalParams::pawnShieldBonus.size()); ++rank)
+			{
+				//the rank's pawns on the king's file and the ones beside it, as three bits
+				const auto rankPawns{ static_cast<unsigned>(own >> (getRelativeRank(rank, color) * lines)) & 0xff };
+				const unsigned zone{ ((rankPawns << 1) >> file) & 0b111 };
+
+				shield += threeBitCounts[zone] * EvalParams::pawnShieldBonus[static_cast<size_t>(rank - 1)];
+			}
+
+			entry.shields[static_cast<size_t>(color)][static_cast<size_t>(file)] = static_cast<std::int8_t>(shield);
+		}
+	}
+
+	entry.structure = static_cast<std::int16_t>(structure);
+
+	return entry;
+}
+
+const Pawns::Entry* Pawns::find(Zobrist::Key key)
+{
+	const Entry& entry{ getTable()[static_cast<size_t>(key & (tableSize - 1))] };
+
+	++s_stats.probes;
+
+	if (entry.key != key)
+		return nullptr;
+
+	++s_stats.hits;
+	return &entry;
+}
+
+const Pawns::Entry& Pawns::store(Zobrist::Key key, const Bitboards& pawns)
+{
+	Entry& entry{ getTable()[static_cast<size_t>(key & (tableSize - 1))] };
+
+	entry = evaluate(pawns);
+	entry.key = key;
+
+	return entry;
+}
+
+int Pawns::getEval(const Entry& entry, const std::array<int, 2>& kingSquares)
+{
+	int eval{ entry.structure };
+
+	for (const auto color : { Piece::Color::White, Piece::Color::Black })
+	{
+		const int kingSquare{ kingSquares[static_cast<size_t>(color)] };
+
+		if (getRelativeRank(kingSquare / lines, color) > 1)
+			continue;
+
+		const int shield{ entry.shields[static_cast<size_t>(color)][static_cast<size_t>(kingSquare % lines)] };
+		eval += (color == Piece::Color::White) ? shield : -shield;
+	}
+
+	return eval;
+}
+
+const Pawns::Stats& Pawns::getStats()
+{
+	return s_stats;
+}
+
+void Pawns::resetStats()
+{
+	s_stats = Stats{};
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "piece.h"
+#include "zobrist.h"
+#include <array>
+#include <cstdint>
+
+//pawn structure evaluation, cached by a key of the pawns alone
+//
+//pawns move far less often than the other pieces, so most evaluations find their pawns' entry already
+//in the table. Each thread has its own table, boards being searched in parallel never share one.
+namespace Pawns
+{
+	using Bitboards = std::array<std::uint64_t, 2>;		//by Piece::Color, a bit per square, a1 = bit 0
+
+	inline constexpr int tableSize{ 1 << 14 };			//entries, a power of two
+
+	struct Entry
+	{
+		Zobrist::Key key{ 0 };								//a position without pawns keys to 0, whose entry is all zeros anyway
+		std::int16_t structure{ 0 };						//doubled, isolated, backward and passed pawns, from white's side
+		std::array<std::array<std::int8_t, 8>, 2> shields{};	//by color and king file, for a king on its first two ranks
+	};
+
+	static_assert(sizeof(Entry) == 32);
+
+	struct Stats
+	{
+		std::uint64_t probes{ 0 };
+		std::uint64_t hits{ 0 };
+
+		double getHitRate() const;
+	};
+
+	Entry evaluate(const Bitboards& pawns);
+
+	//this thread's entry for the key, or nullptr when the table doesn't hold it
+	const Entry* find(Zobrist::Key key);
+	const Entry& store(Zobrist::Key key, const Bitboards& pawns);
+
+	//the entry's eval for these king squares, from white's side
+	int getEval(const Entry& entry, const std::array<int, 2>& kingSquares);
+
+	//of this thread's probes, since it started or last reset them
+	const Stats& getStats();
+	void resetStats();
+}
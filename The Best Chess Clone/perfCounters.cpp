@@ -0,0 +1,175 @@
+#include "perfCounters.h"
+#include <array>
+#include <optional>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef __linux__
+	#include <linux/perf_event.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+	#include <cstring>
+#endif
+
+namespace
+{
+	constexpr std::array<std::string_view, PerfCounters::eventCount> names{ "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses", "dtlb_misses" };
+
+#ifdef __linux__
+	constexpr std::uint64_t getCacheMissConfig(std::uint64_t cache)
+	{
+		return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	}
+
+	struct EventConfig
+	{
+		std::uint32_t type{};
+		std::uint64_t config{};
+	};
+
+	constexpr std::array<EventConfig, PerfCounters::eventCount> configs
+	{ {
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+		{ PERF_TYPE_HW_CACHE, getCacheMissConfig(PERF_COUNT_HW_CACHE_L1D) },
+		{ PERF_TYPE_HW_CACHE, getCacheMissConfig(PERF_COUNT_HW_CACHE_LL) },
+		{ PERF_TYPE_HW_CACHE, getCacheMissConfig(PERF_COUNT_HW_CACHE_DTLB) },
+	} };
+
+	//the times let a count be scaled up when the kernel had to share the hardware between more counters than it has
+	struct CounterValue
+	{
+		std::uint64_t value{};
+		std::uint64_t timeEnabled{};
+		std::uint64_t timeRunning{};
+	};
+
+	int openCounter(const EventConfig& event)
+	{
+		perf_event_attr attributes{};
+		std::memset(&attributes, 0, sizeof(attributes));
+
+		attributes.size = sizeof(attributes);
+		attributes.type = event.type;
+		attributes.config = event.config;
+		attributes.disabled = 1;
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+	}
+#endif
+}
+
+std::optional<std::uint64_t> PerfCounters::Reading::get(Event event) const
+{
+	return values[static_cast<size_t>(event)];
+}
+
+std::optional<double> PerfCounters::Reading::getIpc() const
+{
+	const auto cycles{ get(Event::Cycles) };
+	const auto instructions{ get(Event::Instructions) };
+
+	if (!cycles || !instructions || cycles.value() == 0)
+		return std::nullopt;
+
+	return static_cast<double>(instructions.value()) / static_cast<double>(cycles.value());
+}
+
+std::optional<double> PerfCounters::Reading::getPer(Event event, std::uint64_t units) const
+{
+	const auto value{ get(event) };
+
+	if (!value || units == 0)
+		return std::nullopt;
+
+	return static_cast<double>(value.value()) / static_cast<double>(units);
+}
+
+PerfCounters::PerfCounters()
+{
+	m_files.fill(-1);
+
+#ifdef __linux__
+	for (std::size_t i{ 0 }; i < eventCount; ++i)
+		m_files[i] = openCounter(configs[i]);
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+	for (const int file : m_files)
+		if (file >= 0)
+			close(file);
+#endif
+}
+
+bool PerfCounters::isAvailable() const
+{
+	for (const int file : m_files)
+		if (file >= 0)
+			return true;
+
+	return false;
+}
+
+void PerfCounters::reset()
+{
+#ifdef __linux__
+	for (const int file : m_files)
+		if (file >= 0)
+			ioctl(file, PERF_EVENT_IOC_RESET, 0);
+#endif
+}
+
+void PerfCounters::start()
+{
+#ifdef __linux__
+	for (const int file : m_files)
+		if (file >= 0)
+			ioctl(file, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+}
+
+void PerfCounters::stop()
+{
+#ifdef __linux__
+	for (const int file : m_files)
+		if (file >= 0)
+			ioctl(file, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+}
+
+PerfCounters::Reading PerfCounters::read() const
+{
+	Reading reading{};
+
+#ifdef __linux__
+	for (std::size_t i{ 0 }; i < eventCount; ++i)
+	{
+		CounterValue counter{};
+
+		if (m_files[i] < 0 || ::read(m_files[i], &counter, sizeof(counter)) != static_cast<ssize_t>(sizeof(counter)))
+			continue;
+
+		if (counter.timeRunning == 0)
+			continue;
+
+		const double scale{ static_cast<double>(counter.timeEnabled) / static_cast<double>(counter.timeRunning) };
+		reading.values[i] = static_cast<std::uint64_t>(static_cast<double>(counter.value) * scale);
+	}
+#endif
+
+	return reading;
+}
+
+std::string_view PerfCounters::getName(Event event)
+{
+	return names[static_cast<size_t>(event)];
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <array>
+#include <optional>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+//hardware counters of the calling thread around a measured region, through perf_event_open on Linux
+//
+//each counter is opened on its own, so a machine or container missing some of them still gets the rest.
+//Elsewhere, or where the kernel allows none, nothing is counted and readings hold no values.
+class PerfCounters
+{
+	public:
+
+		enum class Event
+		{
+			Cycles,
+			Instructions,
+			BranchMisses,
+			L1dMisses,
+			LlcMisses,
+			DtlbMisses,
+		};
+
+		static constexpr std::size_t eventCount{ 6 };
+
+		struct Reading
+		{
+			std::array<std::optional<std::uint64_t>, eventCount> values{};		//by Event, empty when it couldn't be counted
+
+			std::optional<std::uint64_t> get(Event event) const;
+			std::optional<double> getIpc() const;
+			std::optional<double> getPer(Event event, std::uint64_t units) const;		//per node, per call...
+		};
+
+		PerfCounters();
+		~PerfCounters();
+
+		bool isAvailable() const;		//whether any of the counters could be opened
+
+		//counting goes on from one start to the next stop, and adds up over them until reset
+		void reset();
+		void start();
+		void stop();
+		Reading read() const;
+
+		static std::string_view getName(Event event);
+
+	private:
+
+		std::array<int, eventCount> m_files{};		//-1 for the counters that couldn't be opened
+
+		PerfCounters(const PerfCounters&) = delete;
+		void operator=(const PerfCounters&) = delete;
+};
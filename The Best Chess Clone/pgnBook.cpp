@@ -0,0 +1,517 @@
+#include "board.h"
+#include "piece.h"
+#include "move.h"
+#include "book.h"
+#include "zobrist.h"
+#include "mappedFile.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <thread>
+#include <algorithm>
+#include <optional>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+
+//builds an opening book from the games of a PGN file
+//
+//usage: pgn_book <games.pgn> [--output path] [--threads n] [--plies n] [--min-count n]
+//the file is memory-mapped and split between the threads at game boundaries. Every game is replayed
+//from the start for its first plies, and each of its moves is counted for the position it was played in.
+//Moves seen fewer than min-count times are left out. Games set up from a FEN are skipped.
+
+namespace
+{
+	constexpr int maxPlies{ 64 };
+
+	struct Options
+	{
+		std::string pgnPath{};
+		std::string outputPath{ "book.bin" };
+		unsigned threads{ std::max(std::thread::hardware_concurrency(), 1u) };
+		int plies{ 20 };
+		int minCount{ 2 };
+	};
+
+	struct PositionMove
+	{
+		Zobrist::Key key{};
+		std::uint16_t move{};
+
+		bool operator==(const PositionMove& positionMove) const = default;
+	};
+
+	struct PositionMoveHash
+	{
+		std::size_t operator()(const PositionMove& positionMove) const
+		{
+			return static_cast<std::size_t>(positionMove.key ^ (std::uint64_t{ positionMove.move } * 0x9E3779B97F4A7C15ull));
+		}
+	};
+
+	struct MoveStats
+	{
+		std::uint32_t count{ 0 };
+		std::uint32_t points{ 0 };		//in half points, for the side that played the move
+	};
+
+	using MoveTable = std::unordered_map<PositionMove, MoveStats, PositionMoveHash>;
+
+	struct Tally
+	{
+		MoveTable moves{};
+		std::uint64_t games{ 0 };
+		std::uint64_t skippedGames{ 0 };
+	};
+
+	std::optional<Options> parseOptions(int argc, char** argv)
+	{
+		Options options{};
+
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			const std::string_view argument{ argv[i] };
+			const bool hasValue{ i + 1 < argc };
+
+			if (argument == "--output" && hasValue)
+				options.outputPath = argv[++i];
+			else if (argument == "--threads" && hasValue)
+				options.threads = static_cast<unsigned>(std::max(std::stoi(argv[++i]), 1));
+			else if (argument == "--plies" && hasValue)
+				options.plies = std::clamp(std::stoi(argv[++i]), 1, maxPlies);
+			else if (argument == "--min-count" && hasValue)
+				options.minCount = std::max(std::stoi(argv[++i]), 1);
+			else if (options.pgnPath.empty() && !argument.starts_with("--"))
+				options.pgnPath = argument;
+			else
+				return std::nullopt;
+		}
+
+		if (options.pgnPath.empty())
+			return std::nullopt;
+
+		return options;
+	}
+
+	bool isSpace(char character)
+	{
+		return character == ' ' || character == '\n' || character == '\r' || character == '\t';
+	}
+
+	//the chunks start where games do, so no game is cut between two threads
+	std::vector<std::string_view> splitAtGames(std::string_view text, unsigned parts)
+	{
+		constexpr std::string_view gameStart{ "\n[Event " };
+
+		std::vector<std::string_view> chunks{};
+		std::size_t start{ 0 };
+
+		for (unsigned i{ 1 }; i <= parts && start < text.size(); ++i)
+		{
+			std::size_t end{ text.size() };
+
+			if (i < parts)
+			{
+				const std::size_t boundary{ text.find(gameStart, std::max(start, text.size() / parts * i)) };
+				end = (boundary == std::string_view::npos) ? text.size() : boundary + 1;
+			}
+
+			chunks.push_back(text.substr(start, end - start));
+			start = end;
+		}
+
+		return chunks;
+	}
+
+	//standard algebraic notation, as in Nbd7, exd8=Q+ or O-O, matched against the position's legal moves
+	std::optional<Move> parseSan(Board& board, std::string_view san)
+	{
+		while (!san.empty() && std::string_view{ "+#!?" }.find(san.back()) != std::string_view::npos)
+			san.remove_suffix(1);
+
+		const auto& legalMoves{ board.getLegalMoves() };
+
+		if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0")
+		{
+			const Move::Flag flag{ (san.size() == 3) ? Move::Flag::KingCastle : Move::Flag::QueenCastle };
+			const auto castling{ std::find_if(legalMoves.begin(), legalMoves.end(), [&](Move move) { return move.getFlag() == flag; }) };
+
+			return (castling == legalMoves.end()) ? std::nullopt : std::optional<Move>{ *castling };
+		}
+
+		std::optional<Piece::Type> promotionType{};
+
+		if (san.size() >= 2 && std::string_view{ "NBRQ" }.find(san.back()) != std::string_view::npos)
+		{
+			promotionType = Piece::getType(static_cast<char>(san.back() - 'A' + 'a'));
+			san.remove_suffix((san[san.size() - 2] == '=') ? 2 : 1);
+		}
+
+		Piece::Type type{ Piece::Type::Pawn };
+
+		if (!san.empty() && std::string_view{ "NBRQK" }.find(san.front()) != std::string_view::npos)
+		{
+			type = Piece::getType(static_cast<char>(san.front() - 'A' + 'a'));
+			san.remove_prefix(1);
+		}
+
+		if (san.size() < 2)
+			return std::nullopt;
+
+		const char targetFile{ san[san.size() - 2] };
+		const char targetRank{ san[san.size() - 1] };
+
+		if (targetFile < 'a' || targetFile > 'h' || targetRank < '1' || targetRank > '8')
+			return std::nullopt;
+
+		const int target{ (targetRank - '1') * 8 + (targetFile - 'a') };
+		int fromFile{ -1 };
+		int fromRank{ -1 };
+
+		for (const char character : san.substr(0, san.size() - 2))
+		{
+			if (character >= 'a' && character <= 'h')
+				fromFile = character - 'a';
+			else if (character >= '1' && character <= '8')
+				fromRank = character - '1';
+			else if (character != 'x')
+				return std::nullopt;
+		}
+
+		std::optional<Move> match{};
+
+		for (const Move move : legalMoves)
+		{
+			const int from{ move.getFrom() };
+
+			if	(
+					move.getTo() != target ||
+					Piece::getType(board(board.toCoordinates(from))) != type ||
+					(fromFile >= 0 && from % 8 != fromFile) ||
+					(fromRank >= 0 && from / 8 != fromRank) ||
+					move.isPromotion() != promotionType.has_value()
+				)
+			{
+				continue;
+			}
+
+			if (match)
+				return std::nullopt;
+
+			match = move;
+		}
+
+		//the move generator only makes queens, the other promotions are the same move with another flag
+		if (match && promotionType && promotionType.value() != Piece::Type::Queen)
+			match = Move{ match->getFrom(), match->getTo(), Move::getPromotionFlag(promotionType.value(), match->isCapture()) };
+
+		return match;
+	}
+
+	//reads the games of a chunk one token at a time, so nothing is allocated per game
+	class GameReader
+	{
+		public:
+
+			GameReader(std::string_view text) : m_text{ text } {}
+
+			bool isDone() const
+			{
+				return m_text.empty();
+			}
+
+			//the next game's tags, up to its first move
+			void readTags(bool& isSetUp)
+			{
+				isSetUp = false;
+
+				while (true)
+				{
+					skipSpace();
+
+					if (m_text.empty() || m_text.front() != '[')
+						return;
+
+					const std::size_t end{ std::min(m_text.find('\n'), m_text.size()) };
+					const std::string_view tag{ m_text.substr(0, end) };
+
+					if (tag.starts_with("[FEN ") || (tag.starts_with("[Variant ") && !tag.starts_with("[Variant \"Standard\"")))
+						isSetUp = true;
+
+					m_text.remove_prefix(end);
+				}
+			}
+
+			//the next move of the game, or nothing once its result or the next game's tags are reached
+			std::optional<std::string_view> readMove(std::string_view& result)
+			{
+				while (true)
+				{
+					skipSpace();
+
+					if (m_text.empty() || m_text.front() == '[')
+						return std::nullopt;
+
+					switch (m_text.front())
+					{
+						case '{': skipPast('}'); continue;
+						case ';': skipPast('\n'); continue;
+						case '(': skipVariation(); continue;
+						default: break;
+					}
+
+					std::size_t end{ 0 };
+
+					while (end < m_text.size() && !isSpace(m_text[end]) && std::string_view{ "{}();[" }.find(m_text[end]) == std::string_view::npos)
+						++end;
+
+					//a stray closing bracket
+					if (end == 0)
+					{
+						m_text.remove_prefix(1);
+						continue;
+					}
+
+					std::string_view token{ m_text.substr(0, end) };
+					m_text.remove_prefix(end);
+
+					if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*")
+					{
+						result = token;
+						return std::nullopt;
+					}
+
+					//move numbers, which can be stuck to the move after them as in 12.e4. Only digits ended by a '.' are one,
+					//so castling written as 0-0 is left alone
+					const std::size_t numberEnd{ token.find_first_not_of("0123456789") };
+
+					if (numberEnd == std::string_view::npos)
+						token = {};
+					else if (numberEnd > 0 && token[numberEnd] == '.')
+						token.remove_prefix(std::min(token.find_first_not_of('.', numberEnd), token.size()));
+
+					if (!token.empty() && token.front() != '$')
+						return token;
+				}
+			}
+
+		private:
+
+			std::string_view m_text{};
+
+			void skipSpace()
+			{
+				while (!m_text.empty() && isSpace(m_text.front()))
+					m_text.remove_prefix(1);
+			}
+
+			void skipPast(char character)
+			{
+				const std::size_t end{ m_text.find(character) };
+				m_text.remove_prefix((end == std::string_view::npos) ? m_text.size() : end + 1);
+			}
+
+			void skipVariation()
+			{
+				int depth{ 0 };
+
+				while (!m_text.empty())
+				{
+					const char character{ m_text.front() };
+					m_text.remove_prefix(1);
+
+					if (character == '{')
+						skipPast('}');
+					else if (character == '(')
+						++depth;
+					else if (character == ')' && --depth == 0)
+						return;
+				}
+			}
+	};
+
+	//white's score in half points
+	std::uint32_t getWhitePoints(std::string_view result)
+	{
+		if (result == "1-0")
+			return 2;
+
+		if (result == "0-1")
+			return 0;
+
+		return 1;
+	}
+
+	void readChunk(std::string_view text, const Options& options, Tally& tally)
+	{
+		const Board startBoard{ Piece::Color::White };
+		Board board{ startBoard };
+		GameReader reader{ text };
+
+		std::array<PositionMove, maxPlies> gameMoves{};
+
+		while (!reader.isDone())
+		{
+			bool isSetUp{ false };
+			reader.readTags(isSetUp);
+
+			board = startBoard;
+
+			int plies{ 0 };
+			bool isValid{ !isSetUp };
+			std::string_view result{};
+
+			while (const auto san{ reader.readMove(result) })
+			{
+				if (!isValid || plies >= options.plies)
+					continue;
+
+				const auto move{ parseSan(board, san.value()) };
+
+				if (!move)
+				{
+					isValid = false;
+					continue;
+				}
+
+				gameMoves[static_cast<size_t>(plies++)] = { board.getPositionKey(), move->getData() };
+				board.makeMove(move.value());
+			}
+
+			//unfinished games still tell what was played, but not how good it was
+			if (result.empty() || result == "*" || !isValid)
+			{
+				if (plies > 0 || !result.empty())
+					++tally.skippedGames;
+
+				continue;
+			}
+
+			const std::uint32_t whitePoints{ getWhitePoints(result) };
+
+			for (int ply{ 0 }; ply < plies; ++ply)
+			{
+				MoveStats& stats{ tally.moves[gameMoves[static_cast<size_t>(ply)]] };
+				++stats.count;
+				stats.points += (ply % 2 == 0) ? whitePoints : 2 - whitePoints;
+			}
+
+			++tally.games;
+		}
+	}
+
+	std::vector<Book::Entry> makeEntries(const MoveTable& moves, int minCount)
+	{
+		std::vector<Book::Entry> entries{};
+
+		for (const auto& [positionMove, stats] : moves)
+		{
+			if (stats.count < static_cast<std::uint32_t>(minCount))
+				continue;
+
+			const auto score{ static_cast<std::uint8_t>(std::uint64_t{ stats.points } * 50 / stats.count) };
+			entries.push_back({ positionMove.key, stats.count, positionMove.move, score });
+		}
+
+		std::sort(entries.begin(), entries.end(), [](const Book::Entry& a, const Book::Entry& b)
+		{
+			if (a.key != b.key)
+				return a.key < b.key;
+
+			return (a.count != b.count) ? a.count > b.count : a.move < b.move;
+		});
+
+		return entries;
+	}
+
+	bool writeBook(const std::string& path, const std::vector<Book::Entry>& entries)
+	{
+		std::ofstream output{ path, std::ios::binary };
+
+		if (!output)
+			return false;
+
+		const std::uint64_t entryCount{ entries.size() };
+
+		output.write(Book::magic.data(), static_cast<std::streamsize>(Book::magic.size()));
+		output.write(reinterpret_cast<const char*>(&entryCount), sizeof(entryCount));
+		output.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(Book::Entry)));
+
+		return static_cast<bool>(output);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const auto options{ parseOptions(argc, argv) };
+
+	if (!options)
+	{
+		std::cout << "usage: pgn_book <games.pgn> [--output path] [--threads n] [--plies n] [--min-count n]\n";
+		return 1;
+	}
+
+	MappedFile file{};
+
+	if (!file.open(options->pgnPath))
+	{
+		std::cout << "Could not read " << options->pgnPath << '\n';
+		return 1;
+	}
+
+	const auto startTime{ std::chrono::steady_clock::now() };
+	const auto data{ file.getData() };
+	const std::string_view text{ reinterpret_cast<const char*>(data.data()), data.size() };
+	const auto chunks{ splitAtGames(text, options->threads) };
+
+	std::vector<Tally> tallies(chunks.size());
+	std::vector<std::thread> threads{};
+
+	for (std::size_t i{ 0 }; i < chunks.size(); ++i)
+		threads.emplace_back(readChunk, chunks[i], std::cref(options.value()), std::ref(tallies[i]));
+
+	for (auto& thread : threads)
+		thread.join();
+
+	Tally total{};
+
+	for (auto& tally : tallies)
+	{
+		total.games += tally.games;
+		total.skippedGames += tally.skippedGames;
+
+		if (total.moves.empty())
+		{
+			total.moves = std::move(tally.moves);
+			continue;
+		}
+
+		for (const auto& [positionMove, stats] : tally.moves)
+		{
+			MoveStats& totalStats{ total.moves[positionMove] };
+			totalStats.count += stats.count;
+			totalStats.points += stats.points;
+		}
+	}
+
+	const auto entries{ makeEntries(total.moves, options->minCount) };
+
+	if (!writeBook(options->outputPath, entries))
+	{
+		std::cout << "Could not write " << options->outputPath << '\n';
+		return 1;
+	}
+
+	const double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() };
+
+	std::cout << "Games " << total.games << "  skipped " << total.skippedGames
+		<< "  moves " << total.moves.size() << "  book entries " << entries.size()
+		<< "  " << static_cast<std::uint64_t>(static_cast<double>(total.games) / seconds * 60.0) << " games/min\n";
+
+	return 0;
+}
@@ -2,14 +2,17 @@
 #include "coordinates.h"
 #include "constants.h"
 #include "board.h"
+#include "trace.h"
+#include "allocTracking.h"
+#include "evalParams.h"
 #include <memory>
+#include <new>
 #include <cctype>
 #include <algorithm>
 #include <vector>
 #include <cmath>
 #include <ranges>
-
-Piece::Color Piece::s_playerColor{ Piece::Color::White };
+#include <string_view>
 
 Piece::Piece(const Coordinates& coordinates, Color color, bool hasMoved)
 	: m_coordinates{ coordinates }, m_color{ color }, m_hasMoved{ hasMoved } {}
@@ -95,36 +98,84 @@ std::unique_ptr<Piece> Piece::toPiece(char letter, const Coordinates& coordinate
 	return nullptr;
 }
 
-bool Piece::isPiece(char letter)
+//for storage owned by someone else, like a PiecePool slot, which must fit any piece type
+Piece* Piece::constructAt(void* address, char letter, const Coordinates& coordinates, bool hasMoved)
 {
-	return letter != 'x';
+	switch (getType(letter))
+	{
+		case Piece::Type::Pawn:
+			return new (address) Pawn{ coordinates, getColor(letter), hasMoved };
+		case Piece::Type::Rook:
+			return new (address) Rook{ coordinates, getColor(letter), hasMoved };
+		case Piece::Type::Knight:
+			return new (address) Knight{ coordinates, getColor(letter), hasMoved };
+		case Piece::Type::Bishop:
+			return new (address) Bishop{ coordinates, getColor(letter), hasMoved };
+		case Piece::Type::Queen:
+			return new (address) Queen{ coordinates, getColor(letter), hasMoved };
+		case Piece::Type::King:
+			return new (address) King{ coordinates, getColor(letter), hasMoved };
+	}
+
+	return nullptr;
 }
 
-void Piece::setPlayerColor(Piece::Color color)
+char Piece::getLetter(Type type, Color color)
 {
-	s_playerColor = color;
+	constexpr std::string_view whiteLetters{ "pnbrqk" };
+	const char letter{ whiteLetters[static_cast<size_t>(type)] };
+
+	return (color == Color::White) ? letter : static_cast<char>(toupper(letter));
 }
 
-Piece::Color Piece::getPlayerColor()
+bool Piece::isPiece(char letter)
 {
-	return s_playerColor;
+	return letter != 'x';
 }
 
-int Piece::getForwardDirection(Piece::Color color)
+//checked on a copy of the squares without this piece, so the board itself is left untouched
+bool Piece::isPinned(const Board& board) const
 {
-	return (s_playerColor == color) ? -1 : 1;
+	BoardMatrix matrix{ board.m_matrix };
+	matrix(m_coordinates) = 'x';
+
+	return board.isAttackedBy(matrix, board.getKingCoordinates(m_color), !m_color);
 }
 
-bool Piece::isPinned(Board& board)
+//the legal moves taking a piece, without working out the quiet ones, which most search nodes never try
+std::vector<Coordinates> Piece::getCaptures(const Board& board) const
 {
-	char& boardPosition{ board.m_matrix(m_coordinates) };
-	const char letter{ boardPosition };
+	TRACE_SCOPE("Piece::getCaptures");
 
-	boardPosition = 'x';
-	bool isCheckWithoutPiece{ board.isKingChecked(m_color) };
-	boardPosition = letter;
+	std::vector<Coordinates> captures{ getAttacks(board) };
+	bool canCaptureEnPassant{ false };
+
+	std::erase_if(captures, [&](const Coordinates& capture)
+	{
+		const bool isEnPassant{ getType() == Type::Pawn && board.isEnPassant(capture, m_color) };
+		canCaptureEnPassant = canCaptureEnPassant || isEnPassant;
 
-	return isCheckWithoutPiece;
+		return !isPiece(board(capture)) && !isEnPassant;
+	});
+
+	if (getType() == Type::King || canCaptureEnPassant || board.isKingChecked(m_color) || isPinned(board))
+		std::erase_if(captures, [&](const Coordinates& capture) { return !board.isLegalMove(m_coordinates, capture); });
+
+	return captures;
+}
+
+//the other half of getMoves, with only the pawns and the king moving differently than they capture
+std::vector<Coordinates> Piece::getQuiets(const Board& board) const
+{
+	TRACE_SCOPE("Piece::getQuiets");
+
+	std::vector<Coordinates> quiets{ getAttacks(board) };
+	std::erase_if(quiets, [&](const Coordinates& quiet) { return isPiece(board(quiet)); });
+
+	if (board.isKingChecked(m_color) || isPinned(board))
+		std::erase_if(quiets, [&](const Coordinates& quiet) { return !board.isLegalMove(m_coordinates, quiet); });
+
+	return quiets;
 }
 
 bool Piece::hasMoved() const
@@ -132,7 +183,7 @@ bool Piece::hasMoved() const
 	return m_hasMoved;
 }
 
-void Piece::addMovedFlag() const
+void Piece::addMovedFlag()
 {
 	m_hasMoved = true;
 }
@@ -197,12 +248,12 @@ Piece::Traits King::getTraits() const
 	return { m_color, Piece::Type::King };
 }
 
-std::vector<Coordinates> Pawn::getAttacks(const Board& board)
+std::vector<Coordinates> Pawn::getAttacks(const Board& board) const
 {
 	std::vector<Coordinates> attacks{};
 
-	Coordinates rightCapture{ m_coordinates + Coordinates{ getForwardDirection(m_color), 1 } };
-	Coordinates leftCapture{ m_coordinates + Coordinates{ getForwardDirection(m_color), -1 } };
+	Coordinates rightCapture{ m_coordinates + Coordinates{ board.getForwardDirection(m_color), 1 } };
+	Coordinates leftCapture{ m_coordinates + Coordinates{ board.getForwardDirection(m_color), -1 } };
 
 	if (!Board::isOutOfBounds(rightCapture))
 	{
@@ -221,7 +272,7 @@ std::vector<Coordinates> Pawn::getAttacks(const Board& board)
 	return attacks;
 }
 
-std::vector<Coordinates> Rook::getAttacks(const Board& board)
+std::vector<Coordinates> Rook::getAttacks(const Board& board) const
 {
 	std::vector<Coordinates> attacks{};
 
@@ -249,7 +300,7 @@ std::vector<Coordinates> Rook::getAttacks(const Board& board)
 	return attacks;
 }
 
-std::vector<Coordinates> Knight::getAttacks(const Board& board)
+std::vector<Coordinates> Knight::getAttacks(const Board& board) const
 {
 	std::vector<Coordinates> attacks{};
 
@@ -268,7 +319,7 @@ std::vector<Coordinates> Knight::getAttacks(const Board& board)
 	return attacks;
 }
 
-std::vector<Coordinates> Bishop::getAttacks(const Board& board)
+std::vector<Coordinates> Bishop::getAttacks(const Board& board) const
 {
 	std::vector<Coordinates> attacks{};
 
@@ -296,7 +347,7 @@ std::vector<Coordinates> Bishop::getAttacks(const Board& board)
 	return attacks;
 }
 
-std::vector<Coordinates> Queen::getAttacks(const Board& board)
+std::vector<Coordinates> Queen::getAttacks(const Board& board) const
 {
 	std::vector<Coordinates> attacks{ Rook{m_coordinates, m_color, true}.getAttacks(board) };
 
@@ -306,7 +357,7 @@ std::vector<Coordinates> Queen::getAttacks(const Board& board)
 	return attacks;
 }
 
-std::vector<Coordinates> King::getAttacks(const Board& board)
+std::vector<Coordinates> King::getAttacks(const Board& board) const
 {
 	std::vector<Coordinates> attacks{};
 
@@ -328,36 +379,68 @@ std::vector<Coordinates> King::getAttacks(const Board& board)
 	return attacks;
 }
 
-std::vector<Coordinates> Pawn::getMoves(Board& board)
+std::vector<Coordinates> Pawn::getMoves(const Board& board) const
+{
+	TRACE_SCOPE("Pawn::getMoves");
+
+	std::vector<Coordinates> moves{ getPushes(board) };
+		
+	//an en passant capture takes two pawns off the rank, so it's checked even when the pawn isn't pinned
+	bool canCaptureEnPassant{ false };
+
+	for (auto& attack : getAttacks(board))
+	{
+		const bool isEnPassant{ board.isEnPassant(attack, m_color) };
+		canCaptureEnPassant = canCaptureEnPassant || isEnPassant;
+
+		if (isPiece(board(attack)) || isEnPassant)
+			moves.push_back(std::move(attack));
+	}
+	
+	if (board.isKingChecked(m_color) || isPinned(board) || canCaptureEnPassant)
+		std::erase_if(moves, [&](const Coordinates& move) { return !board.isLegalMove(m_coordinates, move); });
+
+	return moves;
+}
+
+std::vector<Coordinates> Pawn::getQuiets(const Board& board) const
+{
+	TRACE_SCOPE("Pawn::getQuiets");
+
+	std::vector<Coordinates> quiets{ getPushes(board) };
+
+	if (board.isKingChecked(m_color) || isPinned(board))
+		std::erase_if(quiets, [&](const Coordinates& quiet) { return !board.isLegalMove(m_coordinates, quiet); });
+
+	return quiets;
+}
+
+//one square forward, or two from the starting one, legal or not
+std::vector<Coordinates> Pawn::getPushes(const Board& board) const
 {
-	std::vector<Coordinates> moves{};
+	std::vector<Coordinates> pushes{};
 
-	Coordinates moveForward{ m_coordinates + Coordinates{ getForwardDirection(m_color), 0 } };
+	Coordinates moveForward{ m_coordinates + Coordinates{ board.getForwardDirection(m_color), 0 } };
 
 	if (!board.isOutOfBounds(moveForward) && !isPiece(board(moveForward)))
 	{
-		moves.push_back(std::move(moveForward));
+		pushes.push_back(std::move(moveForward));
 
 		if (!m_hasMoved)
 		{
-			Coordinates moveTwiceForward{ m_coordinates + Coordinates{ getForwardDirection(m_color) * 2, 0 } };
+			Coordinates moveTwiceForward{ m_coordinates + Coordinates{ board.getForwardDirection(m_color) * 2, 0 } };
 			if (!board.isOutOfBounds(moveTwiceForward) && !isPiece(board(moveTwiceForward)))
-				moves.push_back(std::move(moveTwiceForward));
+				pushes.push_back(std::move(moveTwiceForward));
 		}
 	}
-		
-	for (auto& attack : getAttacks(board))
-		if (isPiece(board(attack)) || board.isEnPassant(attack, m_color))
-			moves.push_back(std::move(attack));
-	
-	if (board.isKingChecked(m_color) || isPinned(board))
-		std::erase_if(moves, [&](const Coordinates& move) { return !board.isLegalMove(m_coordinates, move); });
 
-	return moves;
+	return pushes;
 }
 
-std::vector<Coordinates> Rook::getMoves(Board& board)
+std::vector<Coordinates> Rook::getMoves(const Board& board) const
 {
+	TRACE_SCOPE("Rook::getMoves");
+
 	std::vector<Coordinates> moves{ getAttacks(board) };
 
 	if (board.isKingChecked(m_color) || isPinned(board))
@@ -366,8 +449,10 @@ std::vector<Coordinates> Rook::getMoves(Board& board)
 	return moves;
 }
 
-std::vector<Coordinates> Knight::getMoves(Board& board)
+std::vector<Coordinates> Knight::getMoves(const Board& board) const
 {
+	TRACE_SCOPE("Knight::getMoves");
+
 	std::vector<Coordinates> moves{ getAttacks(board) };
 
 	if (board.isKingChecked(m_color) || isPinned(board))
@@ -376,8 +461,10 @@ std::vector<Coordinates> Knight::getMoves(Board& board)
 	return moves;
 }
 
-std::vector<Coordinates> Bishop::getMoves(Board& board)
+std::vector<Coordinates> Bishop::getMoves(const Board& board) const
 {
+	TRACE_SCOPE("Bishop::getMoves");
+
 	std::vector<Coordinates> moves{ getAttacks(board) };
 
 	if (board.isKingChecked(m_color) || isPinned(board))
@@ -386,8 +473,10 @@ std::vector<Coordinates> Bishop::getMoves(Board& board)
 	return moves;
 }
 
-std::vector<Coordinates> Queen::getMoves(Board& board)
+std::vector<Coordinates> Queen::getMoves(const Board& board) const
 {
+	TRACE_SCOPE("Queen::getMoves");
+
 	std::vector<Coordinates> moves{ getAttacks(board) };
 
 	if (board.isKingChecked(m_color) || isPinned(board))
@@ -396,20 +485,42 @@ std::vector<Coordinates> Queen::getMoves(Board& board)
 	return moves;
 }
 
-std::vector<Coordinates> King::getMoves(Board& board)
+std::vector<Coordinates> King::getMoves(const Board& board) const
 {
+	TRACE_SCOPE("King::getMoves");
+	ALLOC_SCOPE("King::getMoves");
+
 	std::vector<Coordinates> moves{ getAttacks(board) };
 	std::erase_if(moves, [&](const Coordinates& move) { return !board.isLegalMove(m_coordinates, move); });
 
+	addCastlings(board, moves);
+
+	return moves;
+}
+
+std::vector<Coordinates> King::getQuiets(const Board& board) const
+{
+	TRACE_SCOPE("King::getQuiets");
+
+	std::vector<Coordinates> quiets{ getAttacks(board) };
+	std::erase_if(quiets, [&](const Coordinates& quiet) { return isPiece(board(quiet)) || !board.isLegalMove(m_coordinates, quiet); });
+	addCastlings(board, quiets);
+
+	return quiets;
+}
+
+//the squares the king lands on when castling
+void King::addCastlings(const Board& board, std::vector<Coordinates>& moves) const
+{
 	if (!m_hasMoved && !board.isKingChecked(m_color))
 	{
 		const auto& kingPieces{ board.getListFromColor(m_color) };
 		
 		std::vector<const Piece*> rooks{};
 
-		for (const auto& piece : kingPieces)
+		for (const auto* piece : kingPieces)
 			if (piece->getType() == Piece::Type::Rook)
-				rooks.push_back(piece.get());
+				rooks.push_back(piece);
 
 		constexpr int castlingMoves{ 2 };
 
@@ -422,7 +533,7 @@ std::vector<Coordinates> King::getMoves(Board& board)
 			bool areMovingSquaresFree{ true };
 			bool isAnyCastlingSquareAttacked{ false };
 
-			int castlingDirection{ (rookCoordinates > m_coordinates) ? 1 : -1 };
+			const int castlingDirection{ (rookCoordinates.y > m_coordinates.y) ? 1 : -1 };
 			int inBetweenSquaresNumber{ abs(m_coordinates.y - rookCoordinates.y) - 1 };
 
 			auto lastCastlingCoordinate{ m_coordinates + Coordinates{ 0, castlingDirection * castlingMoves } };
@@ -437,50 +548,48 @@ std::vector<Coordinates> King::getMoves(Board& board)
 					break;
 				}
 
-				if (squareCoordinates <= lastCastlingCoordinate)
-					if (board.isAttackedBy(squareCoordinates, !m_color))
-					{
-						isAnyCastlingSquareAttacked = true;
-						break;
-					}
+				//only the squares the king crosses and lands on have to be safe, on either side
+				if (i <= castlingMoves && board.isAttackedBy(squareCoordinates, !m_color))
+				{
+					isAnyCastlingSquareAttacked = true;
+					break;
+				}
 			}
 
 			if (areMovingSquaresFree && !isAnyCastlingSquareAttacked)
 				moves.push_back(std::move(lastCastlingCoordinate));
 		}
 	}
-
-	return moves;
 }
 
 int Pawn::getValue() const
 {
-	return 1;
+	return EvalParams::pieceValues[static_cast<size_t>(Piece::Type::Pawn)];
 }
 
 int Knight::getValue() const
 {
-	return 3;
+	return EvalParams::pieceValues[static_cast<size_t>(Piece::Type::Knight)];
 }
 
 int Bishop::getValue() const
 {
-	return 3;
+	return EvalParams::pieceValues[static_cast<size_t>(Piece::Type::Bishop)];
 }
 
 int Rook::getValue() const
 {
-	return 5;
+	return EvalParams::pieceValues[static_cast<size_t>(Piece::Type::Rook)];
 }
 
 int Queen::getValue() const
 {
-	return 9;
+	return EvalParams::pieceValues[static_cast<size_t>(Piece::Type::Queen)];
 }
 
 int King::getValue() const
 {
-	return 0;	//not used directly in evaluations
+	return EvalParams::pieceValues[static_cast<size_t>(Piece::Type::King)];	//not used directly in evaluations
 }
 
 char Pawn::getLetter() const
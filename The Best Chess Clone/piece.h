@@ -32,24 +32,25 @@ class Piece
 		const Coordinates& getCoordinates() const;
 		Coordinates& getCoordinates();
 		bool isSameColorPiece(char letter) const;
-		bool isPinned(Board& board);
+		bool isPinned(const Board& board) const;
+		std::vector<Coordinates> getCaptures(const Board& board) const;
 		bool hasMoved() const;
-		void addMovedFlag() const;
+		void addMovedFlag();
 
 		virtual Type getType() const = 0;
 		virtual Traits getTraits() const = 0;
-		virtual std::vector<Coordinates> getAttacks(const Board& board) = 0;
-		virtual std::vector<Coordinates> getMoves(Board& board) = 0;
+		virtual std::vector<Coordinates> getAttacks(const Board& board) const = 0;
+		virtual std::vector<Coordinates> getMoves(const Board& board) const = 0;
+		virtual std::vector<Coordinates> getQuiets(const Board& board) const;
 		virtual int getValue() const = 0;
 		virtual char getLetter() const = 0;
 
 		static Color getColor(char letter);
 		static Type getType(char letter);
+		static char getLetter(Type type, Color color);
 		static std::unique_ptr<Piece> toPiece(char letter, const Coordinates& coordinates, bool hasMoved);
+		static Piece* constructAt(void* address, char letter, const Coordinates& coordinates, bool hasMoved);
 		static bool isPiece(char letter);
-		static void setPlayerColor(Color color);
-		static Color getPlayerColor();
-		static int getForwardDirection(Color color);
 
 	protected:
 
@@ -57,9 +58,7 @@ class Piece
 
 		Color m_color{};
 		Coordinates m_coordinates{};
-		mutable bool m_hasMoved{ false };
-
-		static Color s_playerColor;
+		bool m_hasMoved{ false };
 };
 
 class Pawn : public Piece
@@ -70,8 +69,11 @@ class Pawn : public Piece
 		Traits getTraits() const override;
 		int getValue() const override;
 		char getLetter() const override;
-		std::vector<Coordinates> getAttacks(const Board& board) override;
-		std::vector<Coordinates> getMoves(Board& board) override;
+		std::vector<Coordinates> getAttacks(const Board& board) const override;
+		std::vector<Coordinates> getMoves(const Board& board) const override;
+		std::vector<Coordinates> getQuiets(const Board& board) const override;
+	private:
+		std::vector<Coordinates> getPushes(const Board& board) const;
 };
 
 class Rook : public Piece
@@ -82,8 +84,8 @@ class Rook : public Piece
 		Traits getTraits() const override;
 		int getValue() const override;
 		char getLetter() const override;
-		std::vector<Coordinates> getAttacks(const Board& board) override;
-		std::vector<Coordinates> getMoves(Board& board) override;
+		std::vector<Coordinates> getAttacks(const Board& board) const override;
+		std::vector<Coordinates> getMoves(const Board& board) const override;
 };
 
 class Knight : public Piece
@@ -94,8 +96,8 @@ class Knight : public Piece
 		Traits getTraits() const override;
 		int getValue() const override;
 		char getLetter() const override;
-		std::vector<Coordinates> getAttacks(const Board& board) override;
-		std::vector<Coordinates> getMoves(Board& board) override;
+		std::vector<Coordinates> getAttacks(const Board& board) const override;
+		std::vector<Coordinates> getMoves(const Board& board) const override;
 };
 
 class Bishop : public Piece
@@ -106,8 +108,8 @@ class Bishop : public Piece
 		Traits getTraits() const override;
 		int getValue() const override;
 		char getLetter() const override;
-		std::vector<Coordinates> getAttacks(const Board& board) override;
-		std::vector<Coordinates> getMoves(Board& board) override;
+		std::vector<Coordinates> getAttacks(const Board& board) const override;
+		std::vector<Coordinates> getMoves(const Board& board) const override;
 };
 
 class Queen : public Piece
@@ -118,8 +120,8 @@ class Queen : public Piece
 		Traits getTraits() const override;
 		int getValue() const override;
 		char getLetter() const override;
-		std::vector<Coordinates> getAttacks(const Board& board) override;
-		std::vector<Coordinates> getMoves(Board& board) override;
+		std::vector<Coordinates> getAttacks(const Board& board) const override;
+		std::vector<Coordinates> getMoves(const Board& board) const override;
 };
 
 class King : public Piece
@@ -130,8 +132,11 @@ class King : public Piece
 		Traits getTraits() const override;
 		int getValue() const override;
 		char getLetter() const override;
-		std::vector<Coordinates> getAttacks(const Board& board) override;
-		std::vector<Coordinates> getMoves(Board& board) override;
+		std::vector<Coordinates> getAttacks(const Board& board) const override;
+		std::vector<Coordinates> getMoves(const Board& board) const override;
+		std::vector<Coordinates> getQuiets(const Board& board) const override;
+	private:
+		void addCastlings(const Board& board, std::vector<Coordinates>& moves) const;
 };
 
 Piece::Color operator!(Piece::Color color);
\ No newline at end of file
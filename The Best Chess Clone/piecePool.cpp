@@ -0,0 +1,117 @@
+#include "piecePool.h"
+#include "piece.h"
+#include "coordinates.h"
+#include <algorithm>
+#include <memory>
+#include <optional>
+
+PiecePool::PiecePool()
+{
+	clear();
+}
+
+PiecePool::PiecePool(const PiecePool& pool)
+{
+	copyFrom(pool);
+}
+
+PiecePool& PiecePool::operator=(const PiecePool& pool)
+{
+	if (this != &pool)
+	{
+		clear();
+		copyFrom(pool);
+	}
+
+	return *this;
+}
+
+PiecePool::~PiecePool()
+{
+	clear();
+}
+
+std::optional<PiecePool::Handle> PiecePool::add(char letter, const Coordinates& coordinates, bool hasMoved)
+{
+	if (m_freeCount == 0)
+		return std::nullopt;
+
+	const Handle handle{ m_freeHandles[static_cast<size_t>(--m_freeCount)] };
+
+	m_pieces[handle] = Piece::constructAt(m_slots[handle].storage, letter, coordinates, hasMoved);
+	m_order[static_cast<size_t>(m_size++)] = handle;
+
+	return handle;
+}
+
+void PiecePool::erase(Handle handle)
+{
+	std::destroy_at(m_pieces[handle]);
+	m_pieces[handle] = nullptr;
+
+	const auto orderEnd{ m_order.begin() + m_size };
+	const auto position{ std::find(m_order.begin(), orderEnd, handle) };
+	std::copy(position + 1, orderEnd, position);
+	--m_size;
+
+	m_freeHandles[static_cast<size_t>(m_freeCount++)] = handle;
+}
+
+void PiecePool::clear()
+{
+	for (int i{ 0 }; i < m_size; ++i)
+	{
+		const Handle handle{ m_order[static_cast<size_t>(i)] };
+		std::destroy_at(m_pieces[handle]);
+		m_pieces[handle] = nullptr;
+	}
+
+	m_size = 0;
+	m_freeCount = capacity;
+
+	//handed out from the top, so the first pieces added take the first slots
+	for (int i{ 0 }; i < capacity; ++i)
+		m_freeHandles[static_cast<size_t>(i)] = static_cast<Handle>(capacity - 1 - i);
+}
+
+Piece* PiecePool::get(Handle handle) const
+{
+	return m_pieces[handle];
+}
+
+int PiecePool::size() const
+{
+	return m_size;
+}
+
+bool PiecePool::empty() const
+{
+	return m_size == 0;
+}
+
+PiecePool::Iterator PiecePool::begin() const
+{
+	return { this, m_order.data() };
+}
+
+PiecePool::Iterator PiecePool::end() const
+{
+	return { this, m_order.data() + m_size };
+}
+
+//the pool is empty here
+void PiecePool::copyFrom(const PiecePool& pool)
+{
+	m_order = pool.m_order;
+	m_freeHandles = pool.m_freeHandles;
+	m_size = pool.m_size;
+	m_freeCount = pool.m_freeCount;
+
+	for (int i{ 0 }; i < m_size; ++i)
+	{
+		const Handle handle{ m_order[static_cast<size_t>(i)] };
+		const Piece* piece{ pool.m_pieces[handle] };
+
+		m_pieces[handle] = Piece::constructAt(m_slots[handle].storage, piece->getLetter(), piece->getCoordinates(), piece->hasMoved());
+	}
+}
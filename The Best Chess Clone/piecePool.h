@@ -0,0 +1,82 @@
+#pragma once
+#include "piece.h"
+#include "coordinates.h"
+#include <array>
+#include <optional>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <cstdint>
+
+//fixed storage for the pieces of one color, constructed in place and reused through a free list
+//
+//a handle is the index of a piece's slot and stays valid until that piece is erased. Copying a pool
+//rebuilds every piece in the same slot of the copy, so handles mean the same in both and nothing is
+//allocated. Iterating yields the pieces in the order they were added.
+class PiecePool
+{
+	public:
+
+		static constexpr int capacity{ 32 };
+
+		using Handle = std::uint8_t;
+
+		class Iterator
+		{
+			public:
+				using iterator_category = std::forward_iterator_tag;
+				using value_type = Piece*;
+				using difference_type = std::ptrdiff_t;
+				using pointer = Piece* const*;
+				using reference = Piece*;
+
+				Iterator() = default;
+				Iterator(const PiecePool* pool, const Handle* handle) : m_pool{ pool }, m_handle{ handle } {}
+
+				Piece* operator*() const { return m_pool->get(*m_handle); }
+				Iterator& operator++() { ++m_handle; return *this; }
+				Iterator operator++(int) { Iterator iterator{ *this }; ++m_handle; return iterator; }
+				bool operator==(const Iterator& iterator) const { return m_handle == iterator.m_handle; }
+
+			private:
+				const PiecePool* m_pool{};
+				const Handle* m_handle{};
+		};
+
+		PiecePool();
+		PiecePool(const PiecePool& pool);
+		PiecePool& operator=(const PiecePool& pool);
+		~PiecePool();
+
+		std::optional<Handle> add(char letter, const Coordinates& coordinates, bool hasMoved);	//empty when the pool is full
+		void erase(Handle handle);
+		void clear();
+
+		//pieces stay mutable through a const pool, as they were through a const list of pointers
+		Piece* get(Handle handle) const;
+
+		int size() const;
+		bool empty() const;
+
+		Iterator begin() const;
+		Iterator end() const;
+
+	private:
+
+		static constexpr std::size_t slotSize{ std::max({ sizeof(Pawn), sizeof(Knight), sizeof(Bishop), sizeof(Rook), sizeof(Queen), sizeof(King) }) };
+		static constexpr std::size_t slotAlignment{ std::max({ alignof(Pawn), alignof(Knight), alignof(Bishop), alignof(Rook), alignof(Queen), alignof(King) }) };
+
+		struct alignas(slotAlignment) Slot
+		{
+			std::byte storage[slotSize];
+		};
+
+		std::array<Slot, capacity> m_slots;
+		std::array<Piece*, capacity> m_pieces{};		//null for free slots
+		std::array<Handle, capacity> m_order{};			//handles of the live pieces, first m_size of them
+		std::array<Handle, capacity> m_freeHandles{};	//a stack, first m_freeCount of them
+		int m_size{ 0 };
+		int m_freeCount{ 0 };
+
+		void copyFrom(const PiecePool& pool);
+};
@@ -0,0 +1,119 @@
+#include "searchStats.h"
+#include "mateSolver.h"
+#include <array>
+#include <string>
+#include <numeric>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+
+std::uint64_t SearchStats::getNodes() const
+{
+	return std::accumulate(nodesPerPly.begin(), nodesPerPly.end(), std::uint64_t{ 0 });
+}
+
+//the n-th root of the deepest complete iteration's nodes, n being its depth in plies
+double SearchStats::getBranchingFactor() const
+{
+	for (auto iteration{ iterations.rbegin() }; iteration != iterations.rend(); ++iteration)
+		if (iteration->isComplete && iteration->nodes > 0)
+			return std::pow(static_cast<double>(iteration->nodes), 1.0 / (iteration->deepness + 1));
+
+	return 0.0;
+}
+
+double SearchStats::getFirstMoveCutoffRate() const
+{
+	return (cutoffs > 0) ? static_cast<double>(firstMoveCutoffs) / static_cast<double>(cutoffs) : 0.0;
+}
+
+double SearchStats::getPawnHitRate() const
+{
+	return (pawnProbes > 0) ? static_cast<double>(pawnHits) / static_cast<double>(pawnProbes) : 0.0;
+}
+
+double SearchStats::getAllocationsPerNode() const
+{
+	const std::uint64_t nodes{ getNodes() };
+	return (nodes > 0) ? static_cast<double>(allocations) / static_cast<double>(nodes) : 0.0;
+}
+
+double SearchStats::getNodesPerSecond() const
+{
+	const double seconds{ std::chrono::duration<double>(time).count() };
+	return (seconds > 0.0) ? static_cast<double>(getNodes()) / seconds : 0.0;
+}
+
+std::string SearchStats::toJson() const
+{
+	const auto toString
+	{
+		[](double value)
+		{
+			char buffer[32]{};
+			std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+			return std::string{ buffer };
+		}
+	};
+
+	const auto toMilliseconds{ [&](std::chrono::nanoseconds duration) { return toString(std::chrono::duration<double, std::milli>(duration).count()); } };
+
+	int deepestPly{ 0 };
+
+	for (int ply{ 0 }; ply < maxPlies; ++ply)
+		if (nodesPerPly[static_cast<size_t>(ply)] > 0)
+			deepestPly = ply;
+
+	std::string json{ "{\"enabled\":" };
+	json += isEnabled() ? "true" : "false";
+	json += ",\"nodes\":" + std::to_string(getNodes());
+	json += ",\"time_ms\":" + toMilliseconds(time);
+	json += ",\"nps\":" + toString(getNodesPerSecond());
+	json += ",\"branching_factor\":" + toString(getBranchingFactor());
+
+	json += ",\"nodes_per_ply\":[";
+	for (int ply{ 1 }; ply <= deepestPly; ++ply)
+		json += ((ply > 1) ? "," : "") + std::to_string(nodesPerPly[static_cast<size_t>(ply)]);
+
+	json += "],\"leaves_per_ply\":[";
+	for (int ply{ 1 }; ply <= deepestPly; ++ply)
+		json += ((ply > 1) ? "," : "") + std::to_string(leavesPerPly[static_cast<size_t>(ply)]);
+
+	json += "],\"transposition\":{\"probes\":" + std::to_string(transpositionProbes);
+	json += ",\"hits\":" + std::to_string(transpositionHits);
+	json += ",\"cutoffs\":" + std::to_string(transpositionCutoffs) + "}";
+	json += ",\"cutoffs\":" + std::to_string(cutoffs);
+	json += ",\"first_move_cutoff_rate\":" + toString(getFirstMoveCutoffRate());
+	json += ",\"pawn_hash\":{\"probes\":" + std::to_string(pawnProbes);
+	json += ",\"hits\":" + std::to_string(pawnHits);
+	json += ",\"hit_rate\":" + toString(getPawnHitRate()) + "}";
+	json += ",\"allocations\":{\"count\":" + std::to_string(allocations);
+	json += ",\"bytes\":" + std::to_string(allocatedBytes);
+	json += ",\"per_node\":" + toString(getAllocationsPerNode()) + "}";
+
+	if (mateSolverStatus)
+	{
+		constexpr std::array<const char*, 3> statuses{ "mate", "no_mate", "unknown" };
+
+		json += ",\"mate_solver\":{\"nodes\":" + std::to_string(mateSolverNodes);
+		json += ",\"status\":\"" + std::string{ statuses[static_cast<size_t>(mateSolverStatus.value())] } + "\"}";
+	}
+
+	json += ",\"iterations\":[";
+	for (size_t i{ 0 }; i < iterations.size(); ++i)
+	{
+		const Iteration& iteration{ iterations[i] };
+
+		json += (i > 0) ? "," : "";
+		json += "{\"depth\":" + std::to_string(iteration.deepness + 1);
+		json += ",\"nodes\":" + std::to_string(iteration.nodes);
+		json += ",\"time_ms\":" + toMilliseconds(iteration.time);
+		json += ",\"complete\":";
+		json += iteration.isComplete ? "true}" : "false}";
+	}
+
+	json += "]}";
+
+	return json;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "mateSolver.h"
+#include <array>
+#include <optional>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+//counting a search statistic is a no-op unless CHESS_SEARCH_STATS is defined, so the counters cost nothing when disabled
+#ifdef CHESS_SEARCH_STATS
+	#define SEARCH_STATS(statement) statement
+#else
+	#define SEARCH_STATS(statement)
+#endif
+
+//what a single call to Board::search did, reset at the start of every search
+struct SearchStats
+{
+	static constexpr int maxPlies{ 64 };
+
+	struct Iteration
+	{
+		int deepness{};
+		std::uint64_t nodes{};
+		std::chrono::nanoseconds time{};
+		bool isComplete{};
+	};
+
+	std::array<std::uint64_t, maxPlies> nodesPerPly{};		//positions reached at each distance from the root
+	std::array<std::uint64_t, maxPlies> leavesPerPly{};		//of those, the ones evaluated or scored as draws
+	std::uint64_t transpositionProbes{ 0 };
+	std::uint64_t transpositionHits{ 0 };
+	std::uint64_t transpositionCutoffs{ 0 };
+	std::uint64_t cutoffs{ 0 };
+	std::uint64_t firstMoveCutoffs{ 0 };
+	std::uint64_t pawnProbes{ 0 };
+	std::uint64_t pawnHits{ 0 };
+	std::uint64_t allocations{ 0 };		//heap allocations, only counted in builds with CHESS_ALLOC_TRACKING
+	std::uint64_t allocatedBytes{ 0 };
+	std::uint64_t mateSolverNodes{ 0 };
+	std::optional<MateSolver::Status> mateSolverStatus{};		//empty when the position didn't call for it
+	std::vector<Iteration> iterations{};
+	std::chrono::nanoseconds time{};
+
+	static constexpr bool isEnabled()
+	{
+	#ifdef CHESS_SEARCH_STATS
+		return true;
+	#else
+		return false;
+	#endif
+	}
+
+	std::uint64_t getNodes() const;
+	double getBranchingFactor() const;
+	double getFirstMoveCutoffRate() const;
+	double getPawnHitRate() const;
+	double getAllocationsPerNode() const;
+	double getNodesPerSecond() const;
+	std::string toJson() const;
+};
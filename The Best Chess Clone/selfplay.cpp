@@ -0,0 +1,358 @@
+#include "board.h"
+#include "piece.h"
+#include "move.h"
+#include "nnue.h"
+#include "transposition.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <optional>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+//engine-vs-engine games between two search configurations, played in parallel, with a running SPRT
+//
+//usage: selfplay [options]
+//	--games n			number of games, rounded up to whole pairs (default 1000)
+//	--threads n			worker threads (default: all cores)
+//	--nodes n			node limit per move for both engines, same for --movetime ms and --depth d
+//	--a-nodes n			the same limits for a single engine, also --a-movetime, --a-depth, --b-nodes...
+//	--mate-nodes n		node limit of the mate solver run alongside tactical searches, also --a-mate-nodes... (default 0, none)
+//	--opening-plies n	random plies played before the engines take over (default 8)
+//	--max-plies n		games longer than this are adjudicated as draws (default 300)
+//	--seed n			seed for the random openings (default 1)
+//	--elo0 x --elo1 x	SPRT hypotheses, in Elo (default 0 and 5)
+//	--alpha x --beta x	SPRT error probabilities (default 0.05 and 0.05)
+//	--net path			use this neural network for both engines
+//
+//every opening is played twice with colors swapped, so the pair cancels out the opening's bias
+
+namespace
+{
+	enum class Outcome
+	{
+		WinA,
+		Draw,
+		WinB,
+	};
+
+	struct Options
+	{
+		int games{ 1000 };
+		unsigned threads{ std::max(std::thread::hardware_concurrency(), 1u) };
+		Board::SearchLimits engineA{};
+		Board::SearchLimits engineB{};
+		int openingPlies{ 8 };
+		int maxPlies{ 300 };
+		std::uint64_t seed{ 1 };
+		double elo0{ 0.0 };
+		double elo1{ 5.0 };
+		double alpha{ 0.05 };
+		double beta{ 0.05 };
+		std::string networkPath{};
+	};
+
+	struct Tally
+	{
+		int winsA{ 0 };
+		int draws{ 0 };
+		int winsB{ 0 };
+		std::uint64_t nodes{ 0 };
+
+		int getGames() const { return winsA + draws + winsB; }
+	};
+
+	bool setLimit(Board::SearchLimits& limits, std::string_view name, const char* value)
+	{
+		//a node or time limit lets iterative deepening go as deep as it can
+		constexpr int unlimitedDeepness{ 64 };
+
+		if (name == "nodes")
+		{
+			limits.nodes = std::stoull(value);
+			limits.deepness = unlimitedDeepness;
+		}
+		else if (name == "movetime")
+		{
+			limits.time = std::chrono::milliseconds{ std::stoll(value) };
+			limits.deepness = unlimitedDeepness;
+		}
+		else if (name == "depth")
+		{
+			limits.deepness = std::stoi(value);
+		}
+		else if (name == "mate-nodes")
+		{
+			limits.mateNodes = std::stoull(value);
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	std::optional<Options> parseOptions(int argc, char** argv)
+	{
+		Options options{};
+
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			const std::string_view argument{ argv[i] };
+
+			if (!argument.starts_with("--") || i + 1 >= argc)
+				return std::nullopt;
+
+			const std::string_view name{ argument.substr(2) };
+			const char* value{ argv[++i] };
+
+			if (name == "games")
+				options.games = std::stoi(value);
+			else if (name == "threads")
+				options.threads = static_cast<unsigned>(std::max(std::stoi(value), 1));
+			else if (name == "opening-plies")
+				options.openingPlies = std::stoi(value);
+			else if (name == "max-plies")
+				options.maxPlies = std::stoi(value);
+			else if (name == "seed")
+				options.seed = std::stoull(value);
+			else if (name == "elo0")
+				options.elo0 = std::stod(value);
+			else if (name == "elo1")
+				options.elo1 = std::stod(value);
+			else if (name == "alpha")
+				options.alpha = std::stod(value);
+			else if (name == "beta")
+				options.beta = std::stod(value);
+			else if (name == "net")
+				options.networkPath = value;
+			else if (name.starts_with("a-"))
+			{
+				if (!setLimit(options.engineA, name.substr(2), value))
+					return std::nullopt;
+			}
+			else if (name.starts_with("b-"))
+			{
+				if (!setLimit(options.engineB, name.substr(2), value))
+					return std::nullopt;
+			}
+			else if (!setLimit(options.engineA, name, value) || !setLimit(options.engineB, name, value))
+				return std::nullopt;
+		}
+
+		options.games += options.games % 2;
+
+		return options;
+	}
+
+	//random legal plies, drawn again until they lead to a position which is still being played
+	std::vector<Move> makeOpening(std::uint64_t seed, int plies)
+	{
+		std::mt19937_64 random{ seed };
+
+		while (true)
+		{
+			Board board{ Piece::Color::White };
+			std::vector<Move> opening{};
+
+			while (static_cast<int>(opening.size()) < plies && board.getGameStatus() == Board::GameStatus::Ongoing)
+			{
+				const auto& moves{ board.getLegalMoves() };
+				const Move move{ moves[random() % moves.size()] };
+
+				board.makeMove(move);
+				opening.push_back(move);
+			}
+
+			if (board.getGameStatus() == Board::GameStatus::Ongoing)
+				return opening;
+		}
+	}
+
+	Outcome playGame(const std::vector<Move>& opening, bool isAWhite, const Options& options, std::uint64_t& nodes)
+	{
+		Board board{ Piece::Color::White };	//every board shares the same orientation
+
+		for (const Move move : opening)
+			board.makeMove(move);
+
+		for (int ply{ 0 }; ply < options.maxPlies; ++ply)
+		{
+			const Board::GameStatus status{ board.getGameStatus() };
+
+			if (status == Board::GameStatus::Checkmate)
+			{
+				const bool hasAWon{ (board.getColorToMove() == Piece::Color::White) != isAWhite };
+				return hasAWon ? Outcome::WinA : Outcome::WinB;
+			}
+
+			if (status != Board::GameStatus::Ongoing)
+				return Outcome::Draw;
+
+			const bool isATurn{ (board.getColorToMove() == Piece::Color::White) == isAWhite };
+
+			//both engines search on this thread, and neither may cut off on what the other stored
+			Transposition::clear();
+			const Board::SearchResult result{ board.search(isATurn ? options.engineA : options.engineB) };
+
+			nodes += result.nodes;
+			board.makeMove(result.move);
+		}
+
+		return Outcome::Draw;
+	}
+
+	double getScore(const Tally& tally)
+	{
+		return (tally.winsA + 0.5 * tally.draws) / std::max(tally.getGames(), 1);
+	}
+
+	double getScoreVariance(const Tally& tally)
+	{
+		const double score{ getScore(tally) };
+		const double games{ static_cast<double>(std::max(tally.getGames(), 1)) };
+
+		return	(tally.winsA * std::pow(1.0 - score, 2) + tally.draws * std::pow(0.5 - score, 2) + tally.winsB * std::pow(score, 2)) / games;
+	}
+
+	double toElo(double score)
+	{
+		constexpr double epsilon{ 1e-6 };
+		score = std::clamp(score, epsilon, 1.0 - epsilon);
+		return 400.0 * std::log10(score / (1.0 - score));
+	}
+
+	double toScore(double elo)
+	{
+		return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+	}
+
+	//generalized SPRT on the trinomial score, with the usual normal approximation
+	double getLogLikelihoodRatio(const Tally& tally, const Options& options)
+	{
+		const double variance{ getScoreVariance(tally) };
+
+		if (tally.getGames() == 0 || variance <= 0.0)
+			return 0.0;
+
+		const double score0{ toScore(options.elo0) };
+		const double score1{ toScore(options.elo1) };
+
+		return tally.getGames() * (score1 - score0) * (2.0 * getScore(tally) - score0 - score1) / (2.0 * variance);
+	}
+
+	void report(const Tally& tally, const Options& options, double seconds)
+	{
+		constexpr double confidence95{ 1.959963984540054 };
+
+		const double score{ getScore(tally) };
+		const double margin{ confidence95 * std::sqrt(getScoreVariance(tally) / std::max(tally.getGames(), 1)) };
+		const double elo{ toElo(score) };
+		const double eloMargin{ (toElo(score + margin) - toElo(score - margin)) / 2.0 };
+
+		const double lowerBound{ std::log(options.beta / (1.0 - options.alpha)) };
+		const double upperBound{ std::log((1.0 - options.beta) / options.alpha) };
+		const double llr{ getLogLikelihoodRatio(tally, options) };
+
+		std::cout << std::fixed << std::setprecision(2)
+			<< "Games " << tally.getGames() << '/' << options.games
+			<< "  W " << tally.winsA << " D " << tally.draws << " L " << tally.winsB
+			<< "  Elo " << elo << " +/- " << eloMargin
+			<< "  LLR " << llr << " [" << lowerBound << ", " << upperBound << "]"
+			<< "  " << tally.getGames() / seconds << " games/s"
+			<< "  " << static_cast<double>(tally.nodes) / seconds << " nodes/s\n";
+	}
+
+	std::string_view getVerdict(const Tally& tally, const Options& options)
+	{
+		const double llr{ getLogLikelihoodRatio(tally, options) };
+
+		if (llr >= std::log((1.0 - options.beta) / options.alpha))
+			return "H1 accepted, A is stronger than B";
+
+		if (llr <= std::log(options.beta / (1.0 - options.alpha)))
+			return "H0 accepted, A is not stronger than B";
+
+		return "inconclusive";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const auto options{ parseOptions(argc, argv) };
+
+	if (!options)
+	{
+		std::cout << "usage: selfplay [--games n] [--threads n] [--nodes n | --movetime ms | --depth d] [--a-* / --b-* limits]\n"
+			<< "                [--opening-plies n] [--max-plies n] [--seed n] [--elo0 x] [--elo1 x] [--alpha x] [--beta x] [--net path]\n";
+		return 1;
+	}
+
+	if (!options->networkPath.empty() && !Nnue::load(options->networkPath))
+	{
+		std::cout << "Could not load " << options->networkPath << '\n';
+		return 1;
+	}
+
+	const int pairs{ options->games / 2 };
+	const int reportInterval{ std::max(options->games / 20, 2) };
+	const auto startTime{ std::chrono::steady_clock::now() };
+
+	std::atomic<int> nextPair{ 0 };
+	std::atomic<bool> isDecided{ false };
+	std::mutex tallyMutex{};
+	Tally tally{};
+
+	const auto getSeconds{ [&]() { return std::max(std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count(), 1e-9); } };
+
+	std::vector<std::thread> workers{};
+
+	for (unsigned i{ 0 }; i < options->threads; ++i)
+	{
+		workers.emplace_back([&]()
+		{
+			for (int pair{ nextPair++ }; pair < pairs && !isDecided; pair = nextPair++)
+			{
+				const auto opening{ makeOpening(options->seed * 0x9E3779B97F4A7C15ull + static_cast<std::uint64_t>(pair), options->openingPlies) };
+
+				for (const bool isAWhite : { true, false })
+				{
+					std::uint64_t nodes{ 0 };
+					const Outcome outcome{ playGame(opening, isAWhite, options.value(), nodes) };
+
+					const std::lock_guard lock{ tallyMutex };
+
+					tally.winsA += (outcome == Outcome::WinA);
+					tally.draws += (outcome == Outcome::Draw);
+					tally.winsB += (outcome == Outcome::WinB);
+					tally.nodes += nodes;
+
+					if (tally.getGames() % reportInterval == 0)
+						report(tally, options.value(), getSeconds());
+
+					if (getVerdict(tally, options.value()) != "inconclusive")
+						isDecided = true;
+				}
+			}
+		});
+	}
+
+	for (auto& worker : workers)
+		worker.join();
+
+	if (tally.getGames() % reportInterval != 0)
+		report(tally, options.value(), getSeconds());
+
+	std::cout << "SPRT: " << getVerdict(tally, options.value()) << '\n';
+
+	return 0;
+}
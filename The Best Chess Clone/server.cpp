@@ -0,0 +1,837 @@
+#include "board.h"
+#include "piece.h"
+#include "move.h"
+#include "nnue.h"
+#include "book.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <csignal>
+#include <cerrno>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <optional>
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <cstdint>
+
+//headless games against the engine for many clients at once, over a line protocol on a local socket
+//
+//usage: chess_server [options]
+//	--port n			TCP port on 127.0.0.1 (default 7878)
+//	--unix path			listen on this Unix socket instead
+//	--threads n			search workers (default: all cores)
+//	--queue n			searches that may wait for a worker before moves are turned away (default 4096)
+//	--depth d			the engine's limits, also --nodes n and --movetime ms (default depth 2, as in the game)
+//	--net path			evaluate with this neural network
+//	--book path			play the engine's first moves from this opening book
+//
+//one command per line, and every reply is a line too:
+//	new white|black		game <id>, followed by the engine's first move when the client plays black
+//	move <id> <move>	the engine's reply as ai <id> <move> <status>, over <id> <status> when the
+//						client's move ends the game, illegal <id>, or busy <id> when it can't be taken now
+//	resign <id>			resigned <id>
+//	stats				stats games <n> moves <n> p50_ms <x> p99_ms <y>
+//moves are in coordinate notation (e2e4, e7e8q) and a status is ongoing, checkmate, stalemate or draw
+//
+//games live on the event loop's thread. A game's board is only handed to a worker while the engine's
+//reply is searched, and the move's latency runs from reading the client's move to queueing the reply.
+
+namespace
+{
+	struct Options
+	{
+		int port{ 7878 };
+		std::string unixPath{};
+		unsigned threads{ std::max(std::thread::hardware_concurrency(), 1u) };
+		std::size_t queueCapacity{ 4096 };
+		Board::SearchLimits limits{};
+		std::string networkPath{};
+		std::string bookPath{};
+	};
+
+	struct Game
+	{
+		Board board;
+		std::uint64_t connectionId{};
+		Piece::Color playerColor{};
+		bool isSearching{ false };
+		std::atomic<bool> isAbandoned{ false };		//its connection closed or it was resigned while queued or searched, read by the workers too
+	};
+
+	struct Job
+	{
+		int gameId{};
+		Game* game{};
+		std::chrono::steady_clock::time_point startTime{};
+	};
+
+	struct Completion
+	{
+		int gameId{};
+		std::string reply{};
+		bool isOver{ false };
+		std::chrono::steady_clock::time_point startTime{};
+	};
+
+	struct Connection
+	{
+		int fd{};
+		std::uint64_t id{};
+		std::string input{};
+		std::string output{};
+		std::vector<int> gameIds{};
+		bool isWaitingToWrite{ false };
+	};
+
+	constexpr std::size_t maxLineLength{ 256 };
+	constexpr int maxEvents{ 256 };
+	constexpr std::chrono::seconds reportInterval{ 5 };
+
+	std::string_view toString(Board::GameStatus status)
+	{
+		switch (status)
+		{
+			case Board::GameStatus::Ongoing:
+				return "ongoing";
+			case Board::GameStatus::Checkmate:
+				return "checkmate";
+			case Board::GameStatus::Stalemate:
+				return "stalemate";
+			default:
+				return "draw";
+		}
+	}
+
+	std::vector<std::string_view> split(std::string_view line)
+	{
+		std::vector<std::string_view> words{};
+
+		while (!line.empty())
+		{
+			const std::size_t start{ line.find_first_not_of(' ') };
+
+			if (start == std::string_view::npos)
+				break;
+
+			line.remove_prefix(start);
+
+			const std::size_t end{ std::min(line.find(' '), line.size()) };
+			words.push_back(line.substr(0, end));
+			line.remove_prefix(end);
+		}
+
+		return words;
+	}
+
+	std::optional<int> toInt(std::string_view text)
+	{
+		int value{};
+		const auto [end, error] { std::from_chars(text.data(), text.data() + text.size(), value) };
+
+		if (error != std::errc{} || end != text.data() + text.size())
+			return std::nullopt;
+
+		return value;
+	}
+
+	bool setLimit(Board::SearchLimits& limits, std::string_view name, const char* value)
+	{
+		if (name == "nodes")
+			limits.nodes = std::stoull(value);
+		else if (name == "movetime")
+			limits.time = std::chrono::milliseconds{ std::stoll(value) };
+		else if (name == "depth")
+			limits.deepness = std::max(std::stoi(value) - 1, 0);
+		else
+			return false;
+
+		return true;
+	}
+
+	std::optional<Options> parseOptions(int argc, char** argv)
+	{
+		Options options{};
+
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			const std::string_view argument{ argv[i] };
+
+			if (!argument.starts_with("--") || i + 1 >= argc)
+				return std::nullopt;
+
+			const std::string_view name{ argument.substr(2) };
+			const char* value{ argv[++i] };
+
+			if (name == "port")
+				options.port = std::stoi(value);
+			else if (name == "unix")
+				options.unixPath = value;
+			else if (name == "threads")
+				options.threads = static_cast<unsigned>(std::max(std::stoi(value), 1));
+			else if (name == "queue")
+				options.queueCapacity = static_cast<std::size_t>(std::max(std::stoi(value), 1));
+			else if (name == "net")
+				options.networkPath = value;
+			else if (name == "book")
+				options.bookPath = value;
+			else if (!setLimit(options.limits, name, value))
+				return std::nullopt;
+		}
+
+		return options;
+	}
+
+	//the latest moves' latencies, enough for stable percentiles without growing with the server's uptime
+	class LatencyLog
+	{
+		public:
+
+			void add(std::chrono::steady_clock::duration latency)
+			{
+				m_samples[m_count % m_samples.size()] = std::chrono::duration<double, std::milli>(latency).count();
+				++m_count;
+			}
+
+			std::uint64_t getCount() const
+			{
+				return m_count;
+			}
+
+			double getPercentile(double percentile) const
+			{
+				const std::size_t size{ static_cast<std::size_t>(std::min<std::uint64_t>(m_count, m_samples.size())) };
+
+				if (size == 0)
+					return 0.0;
+
+				std::vector<double> sorted(m_samples.begin(), m_samples.begin() + static_cast<std::ptrdiff_t>(size));
+				const auto rank{ static_cast<std::size_t>(percentile / 100.0 * static_cast<double>(size - 1) + 0.5) };
+				std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(rank), sorted.end());
+
+				return sorted[rank];
+			}
+
+		private:
+
+			std::array<double, 1 << 16> m_samples{};
+			std::uint64_t m_count{ 0 };
+	};
+
+	//a bounded queue of searches and the threads working through it, finished replies are signalled on an eventfd
+	class WorkerPool
+	{
+		public:
+
+			WorkerPool(const Options& options, int eventFd)
+				: m_limits{ options.limits }, m_capacity{ options.queueCapacity }, m_eventFd{ eventFd }
+			{
+				for (unsigned i{ 0 }; i < options.threads; ++i)
+					m_workers.emplace_back([this]() { work(); });
+			}
+
+			~WorkerPool()
+			{
+				{
+					const std::lock_guard lock{ m_mutex };
+					m_isStopping = true;
+				}
+
+				m_condition.notify_all();
+
+				for (auto& worker : m_workers)
+					worker.join();
+			}
+
+			WorkerPool(const WorkerPool&) = delete;
+			void operator=(const WorkerPool&) = delete;
+
+			//only the event loop pushes, so the room seen here is still there for its next push
+			bool hasRoom()
+			{
+				const std::lock_guard lock{ m_mutex };
+				return m_jobs.size() < m_capacity;
+			}
+
+			std::size_t getQueued()
+			{
+				const std::lock_guard lock{ m_mutex };
+				return m_jobs.size();
+			}
+
+			void push(const Job& job)
+			{
+				{
+					const std::lock_guard lock{ m_mutex };
+					m_jobs.push_back(job);
+				}
+
+				m_condition.notify_one();
+			}
+
+			std::vector<Completion> takeCompletions()
+			{
+				std::uint64_t count{};
+				[[maybe_unused]] const auto bytes{ read(m_eventFd, &count, sizeof(count)) };
+
+				const std::lock_guard lock{ m_mutex };
+				return std::exchange(m_completions, {});
+			}
+
+		private:
+
+			void work()
+			{
+				while (true)
+				{
+					Job job{};
+
+					{
+						std::unique_lock lock{ m_mutex };
+						m_condition.wait(lock, [&]() { return m_isStopping || !m_jobs.empty(); });
+
+						if (m_isStopping)
+							return;
+
+						job = m_jobs.front();
+						m_jobs.pop_front();
+					}
+
+					//a game given up while it waited isn't searched, but its completion still lets the event loop free it
+					Completion completion{ job.gameId, {}, true, job.startTime };
+
+					if (!job.game->isAbandoned.load(std::memory_order_relaxed))
+					{
+						Board& board{ job.game->board };
+						const auto bookMove{ board.getBookMove() };
+						const Move move{ bookMove ? bookMove.value() : board.search(m_limits).move };
+						board.makeMove(move);
+
+						const Board::GameStatus status{ board.getGameStatus() };
+						completion.reply = "ai " + std::to_string(job.gameId) + ' ' + move.toString() + ' ' + std::string{ toString(status) } + '\n';
+						completion.isOver = status != Board::GameStatus::Ongoing;
+					}
+
+					{
+						const std::lock_guard lock{ m_mutex };
+						m_completions.push_back(std::move(completion));
+					}
+
+					const std::uint64_t one{ 1 };
+					[[maybe_unused]] const auto bytes{ write(m_eventFd, &one, sizeof(one)) };
+				}
+			}
+
+			Board::SearchLimits m_limits{};
+			std::size_t m_capacity{};
+			int m_eventFd{};
+
+			std::mutex m_mutex{};
+			std::condition_variable m_condition{};
+			std::deque<Job> m_jobs{};
+			std::vector<Completion> m_completions{};
+			bool m_isStopping{ false };
+
+			std::vector<std::thread> m_workers{};
+	};
+
+	class Server
+	{
+		public:
+
+			Server(const Options& options)
+				: m_options{ options } {}
+
+			~Server()
+			{
+				for (const auto& [fd, connection] : m_connections)
+					close(fd);
+
+				for (const int fd : { m_listenFd, m_eventFd, m_signalFd, m_epollFd })
+					if (fd >= 0)
+						close(fd);
+
+				if (!m_options.unixPath.empty())
+					unlink(m_options.unixPath.c_str());
+			}
+
+			Server(const Server&) = delete;
+			void operator=(const Server&) = delete;
+
+			bool start()
+			{
+				m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+				m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+				//the workers inherit this mask, so the signals only ever reach the signalfd
+				sigset_t signals{};
+				sigemptyset(&signals);
+				sigaddset(&signals, SIGINT);
+				sigaddset(&signals, SIGTERM);
+				pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+				std::signal(SIGPIPE, SIG_IGN);
+				m_signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+				if (m_epollFd < 0 || m_eventFd < 0 || m_signalFd < 0 || !listen())
+					return false;
+
+				for (const int fd : { m_listenFd, m_eventFd, m_signalFd })
+					watch(fd, EPOLLIN, EPOLL_CTL_ADD);
+
+				m_workers = std::make_unique<WorkerPool>(m_options, m_eventFd);
+
+				return true;
+			}
+
+			void run()
+			{
+				std::array<epoll_event, maxEvents> events{};
+				auto lastReportTime{ std::chrono::steady_clock::now() };
+				std::uint64_t lastReportMoves{ 0 };
+
+				while (!m_isStopping)
+				{
+					const int count{ epoll_wait(m_epollFd, events.data(), maxEvents, 1000) };
+
+					for (int i{ 0 }; i < count; ++i)
+					{
+						const int fd{ events[static_cast<size_t>(i)].data.fd };
+						const std::uint32_t flags{ events[static_cast<size_t>(i)].events };
+
+						if (fd == m_listenFd)
+							accept();
+						else if (fd == m_eventFd)
+							completeSearches();
+						else if (fd == m_signalFd)
+							m_isStopping = true;
+						else
+							serve(fd, flags);
+					}
+
+					const auto now{ std::chrono::steady_clock::now() };
+
+					if (now - lastReportTime >= reportInterval && m_latencies.getCount() != lastReportMoves)
+					{
+						report(std::chrono::duration<double>(now - lastReportTime).count(), m_latencies.getCount() - lastReportMoves);
+						lastReportTime = now;
+						lastReportMoves = m_latencies.getCount();
+					}
+				}
+
+				//the searches still running finish here, before the games they work on go away
+				m_workers.reset();
+				std::cout << "Stopped after " << m_latencies.getCount() << " moves\n";
+				report(0.0, 0);
+			}
+
+		private:
+
+			bool listen()
+			{
+				if (!m_options.unixPath.empty())
+				{
+					sockaddr_un address{};
+					address.sun_family = AF_UNIX;
+
+					if (m_options.unixPath.size() >= sizeof(address.sun_path))
+						return false;
+
+					std::copy(m_options.unixPath.begin(), m_options.unixPath.end(), address.sun_path);
+					unlink(m_options.unixPath.c_str());
+
+					m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+					if (m_listenFd < 0 || bind(m_listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0)
+						return false;
+				}
+				else
+				{
+					sockaddr_in address{};
+					address.sin_family = AF_INET;
+					address.sin_port = htons(static_cast<std::uint16_t>(m_options.port));
+					address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+					m_listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+					const int enable{ 1 };
+
+					if (m_listenFd < 0 || setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) < 0)
+						return false;
+
+					if (bind(m_listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0)
+						return false;
+				}
+
+				return ::listen(m_listenFd, SOMAXCONN) == 0;
+			}
+
+			void watch(int fd, std::uint32_t flags, int operation)
+			{
+				epoll_event event{};
+				event.events = flags;
+				event.data.fd = fd;
+				epoll_ctl(m_epollFd, operation, fd, &event);
+			}
+
+			void accept()
+			{
+				while (true)
+				{
+					const int fd{ accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC) };
+
+					if (fd < 0)
+						return;
+
+					//replies are single short lines, so they shouldn't wait to be coalesced
+					const int enable{ 1 };
+					setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+					const std::uint64_t id{ m_nextConnectionId++ };
+					m_connections.emplace(fd, Connection{ fd, id });
+					m_connectionFds.emplace(id, fd);
+					watch(fd, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_ADD);
+				}
+			}
+
+			void serve(int fd, std::uint32_t flags)
+			{
+				const auto found{ m_connections.find(fd) };
+
+				if (found == m_connections.end())
+					return;
+
+				Connection& connection{ found->second };
+				bool isClosed{ (flags & (EPOLLHUP | EPOLLERR)) != 0 };
+
+				if (flags & (EPOLLIN | EPOLLRDHUP))
+				{
+					std::array<char, 4096> buffer{};
+
+					while (true)
+					{
+						const ssize_t bytes{ recv(fd, buffer.data(), buffer.size(), 0) };
+
+						if (bytes > 0)
+						{
+							connection.input.append(buffer.data(), static_cast<size_t>(bytes));
+							continue;
+						}
+
+						isClosed = isClosed || bytes == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+						break;
+					}
+
+					std::size_t lineEnd{};
+
+					while ((lineEnd = connection.input.find('\n')) != std::string::npos)
+					{
+						std::string_view line{ connection.input.data(), lineEnd };
+
+						if (line.ends_with('\r'))
+							line.remove_suffix(1);
+
+						handle(connection, line);
+						connection.input.erase(0, lineEnd + 1);
+					}
+
+					isClosed = isClosed || connection.input.size() > maxLineLength;
+				}
+
+				if (isClosed)
+					disconnect(connection);
+				else
+					flush(connection);
+			}
+
+			void flush(Connection& connection)
+			{
+				while (!connection.output.empty())
+				{
+					const ssize_t bytes{ send(connection.fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL) };
+
+					if (bytes <= 0)
+						break;
+
+					connection.output.erase(0, static_cast<size_t>(bytes));
+				}
+
+				//only asks to hear about writable sockets while there's something left to write
+				const bool isWaitingToWrite{ !connection.output.empty() };
+
+				if (isWaitingToWrite != connection.isWaitingToWrite)
+				{
+					watch(connection.fd, EPOLLIN | EPOLLRDHUP | (isWaitingToWrite ? EPOLLOUT : 0u), EPOLL_CTL_MOD);
+					connection.isWaitingToWrite = isWaitingToWrite;
+				}
+			}
+
+			void disconnect(Connection& connection)
+			{
+				for (const int gameId : connection.gameIds)
+					endGame(gameId);
+
+				epoll_ctl(m_epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+				close(connection.fd);
+				m_connectionFds.erase(connection.id);
+				m_connections.erase(connection.fd);
+			}
+
+			//a game being searched is only marked, and goes away once its worker is done with it
+			void endGame(int gameId)
+			{
+				const auto found{ m_games.find(gameId) };
+
+				if (found == m_games.end())
+					return;
+
+				if (found->second->isSearching)
+					found->second->isAbandoned = true;
+				else
+					m_games.erase(found);
+			}
+
+			void dispatchSearch(int gameId, Game& game, std::chrono::steady_clock::time_point startTime)
+			{
+				game.isSearching = true;
+				m_workers->push({ gameId, &game, startTime });
+			}
+
+			void handle(Connection& connection, std::string_view line)
+			{
+				const auto startTime{ std::chrono::steady_clock::now() };
+				const auto words{ split(line) };
+
+				if (words.empty())
+					return;
+
+				const std::string_view command{ words[0] };
+
+				if (command == "new" && words.size() == 2 && (words[1] == "white" || words[1] == "black"))
+				{
+					if (!m_workers->hasRoom())
+					{
+						connection.output += "busy\n";
+						return;
+					}
+
+					const Piece::Color playerColor{ (words[1] == "white") ? Piece::Color::White : Piece::Color::Black };
+					const int gameId{ m_nextGameId++ };
+					Game& game{ *m_games.emplace(gameId, std::make_unique<Game>(Board{ playerColor }, connection.id, playerColor)).first->second };
+
+					connection.gameIds.push_back(gameId);
+					connection.output += "game " + std::to_string(gameId) + '\n';
+
+					if (playerColor == Piece::Color::Black)
+						dispatchSearch(gameId, game, startTime);
+				}
+				else if (command == "move" && words.size() == 3)
+				{
+					const auto gameId{ toInt(words[1]) };
+					Game* game{ findGame(connection, gameId) };
+
+					if (!game)
+					{
+						connection.output += "error unknown game\n";
+						return;
+					}
+
+					const std::string id{ std::to_string(gameId.value()) };
+
+					if (game->isSearching || !m_workers->hasRoom())
+					{
+						connection.output += "busy " + id + '\n';
+						return;
+					}
+
+					Board& board{ game->board };
+					const auto move{ board.parseMove(words[2]) };
+
+					if (!move || !board.isValidMove(board.toCoordinates(move->getFrom()), board.toCoordinates(move->getTo())))
+					{
+						connection.output += "illegal " + id + '\n';
+						return;
+					}
+
+					board.makeMove(move.value());
+
+					const Board::GameStatus status{ board.getGameStatus() };
+
+					if (status != Board::GameStatus::Ongoing)
+					{
+						connection.output += "over " + id + ' ' + std::string{ toString(status) } + '\n';
+						removeGame(connection, gameId.value());
+						return;
+					}
+
+					dispatchSearch(gameId.value(), *game, startTime);
+				}
+				else if (command == "resign" && words.size() == 2)
+				{
+					const auto gameId{ toInt(words[1]) };
+
+					if (!findGame(connection, gameId))
+					{
+						connection.output += "error unknown game\n";
+						return;
+					}
+
+					connection.output += "resigned " + std::to_string(gameId.value()) + '\n';
+					removeGame(connection, gameId.value());
+				}
+				else if (command == "stats" && words.size() == 1)
+				{
+					std::ostringstream stats{};
+					stats << std::fixed << std::setprecision(3) << "stats games " << m_games.size() << " moves " << m_latencies.getCount()
+						<< " p50_ms " << m_latencies.getPercentile(50.0) << " p99_ms " << m_latencies.getPercentile(99.0) << '\n';
+
+					connection.output += stats.str();
+				}
+				else
+				{
+					connection.output += "error unknown command\n";
+				}
+			}
+
+			Game* findGame(const Connection& connection, std::optional<int> gameId)
+			{
+				if (!gameId)
+					return nullptr;
+
+				const auto found{ m_games.find(gameId.value()) };
+
+				if (found == m_games.end() || found->second->connectionId != connection.id || found->second->isAbandoned)
+					return nullptr;
+
+				return found->second.get();
+			}
+
+			void removeGame(Connection& connection, int gameId)
+			{
+				std::erase(connection.gameIds, gameId);
+				endGame(gameId);
+			}
+
+			void completeSearches()
+			{
+				const auto now{ std::chrono::steady_clock::now() };
+
+				for (auto& completion : m_workers->takeCompletions())
+				{
+					const auto found{ m_games.find(completion.gameId) };
+
+					if (found == m_games.end())
+						continue;
+
+					Game& game{ *found->second };
+					game.isSearching = false;
+
+					if (game.isAbandoned)
+					{
+						m_games.erase(found);
+						continue;
+					}
+
+					m_latencies.add(now - completion.startTime);
+
+					const auto connectionFd{ m_connectionFds.find(game.connectionId) };
+					Connection& connection{ m_connections.at(connectionFd->second) };
+
+					connection.output += completion.reply;
+
+					if (completion.isOver)
+						removeGame(connection, completion.gameId);
+
+					flush(connection);
+				}
+			}
+
+			void report(double seconds, std::uint64_t moves)
+			{
+				std::cout << std::fixed << std::setprecision(2)
+					<< "Games " << m_games.size() << "  connections " << m_connections.size()
+					<< "  moves " << m_latencies.getCount();
+
+				if (seconds > 0.0)
+					std::cout << "  " << static_cast<double>(moves) / seconds << " moves/s";
+
+				std::cout << "  p50 " << m_latencies.getPercentile(50.0) << " ms  p99 " << m_latencies.getPercentile(99.0) << " ms"
+					<< "  queued " << (m_workers ? m_workers->getQueued() : 0) << '\n';
+			}
+
+			Options m_options{};
+
+			int m_epollFd{ -1 };
+			int m_listenFd{ -1 };
+			int m_eventFd{ -1 };
+			int m_signalFd{ -1 };
+			bool m_isStopping{ false };
+
+			std::unordered_map<int, Connection> m_connections{};				//by socket
+			std::unordered_map<std::uint64_t, int> m_connectionFds{};			//sockets by connection id, which unlike sockets are never reused
+			std::unordered_map<int, std::unique_ptr<Game>> m_games{};
+			std::uint64_t m_nextConnectionId{ 1 };
+			int m_nextGameId{ 1 };
+
+			LatencyLog m_latencies{};
+
+			//declared last, so it's destroyed first and its workers stop before the games they hold
+			std::unique_ptr<WorkerPool> m_workers{};
+	};
+}
+
+int main(int argc, char** argv)
+{
+	const auto options{ parseOptions(argc, argv) };
+
+	if (!options)
+	{
+		std::cout << "usage: chess_server [--port n | --unix path] [--threads n] [--queue n] [--depth d | --nodes n | --movetime ms] [--net path] [--book path]\n";
+		return 1;
+	}
+
+	if (!options->networkPath.empty() && !Nnue::load(options->networkPath))
+	{
+		std::cout << "Could not load " << options->networkPath << '\n';
+		return 1;
+	}
+
+	if (!options->bookPath.empty() && !Book::load(options->bookPath))
+	{
+		std::cout << "Could not load " << options->bookPath << '\n';
+		return 1;
+	}
+
+	Server server{ options.value() };
+
+	if (!server.start())
+	{
+		std::cout << "Could not listen on " << (options->unixPath.empty() ? "port " + std::to_string(options->port) : options->unixPath) << '\n';
+		return 1;
+	}
+
+	std::cout << "Listening on " << (options->unixPath.empty() ? "127.0.0.1:" + std::to_string(options->port) : options->unixPath)
+		<< " with " << options->threads << " search threads\n";
+
+	server.run();
+
+	return 0;
+}
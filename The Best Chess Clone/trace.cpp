@@ -0,0 +1,131 @@
+#include "trace.h"
+
+#ifdef CHESS_TRACE
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+
+namespace
+{
+	constexpr std::size_t eventsPerThread{ 1 << 16 };	//a power of two, so the ring index is a mask
+
+	struct Event
+	{
+		const char* name{};
+		std::uint64_t startTime{};
+		std::uint64_t duration{};
+	};
+
+	//written only by its own thread; the head is published with release so a flush sees whole events
+	struct ThreadBuffer
+	{
+		int threadId{};
+		std::atomic<std::uint64_t> head{ 0 };
+		std::array<Event, eventsPerThread> events{};
+	};
+
+	//owns every buffer, so they outlive the threads that wrote them and can be flushed at exit
+	class Session
+	{
+		public:
+			~Session()
+			{
+				const char* path{ std::getenv("CHESS_TRACE_FILE") };
+				flush((path && *path) ? path : "chess_trace.json");
+			}
+
+			ThreadBuffer& addThread()
+			{
+				const std::lock_guard lock{ m_mutex };
+
+				auto& buffer{ m_buffers.emplace_back(std::make_unique<ThreadBuffer>()) };
+				buffer->threadId = static_cast<int>(m_buffers.size());
+
+				return *buffer;
+			}
+
+			std::uint64_t getTime() const
+			{
+				return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime).count());
+			}
+
+			bool flush(std::string_view path)
+			{
+				const std::lock_guard lock{ m_mutex };
+
+				std::ofstream file{ std::string{ path } };
+
+				if (!file)
+					return false;
+
+				file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+				bool isFirst{ true };
+				char line[256]{};
+
+				for (const auto& buffer : m_buffers)
+				{
+					const std::uint64_t head{ buffer->head.load(std::memory_order_acquire) };
+					const std::uint64_t first{ (head > eventsPerThread) ? head - eventsPerThread : 0 };
+
+					for (std::uint64_t i{ first }; i < head; ++i)
+					{
+						const Event& event{ buffer->events[i & (eventsPerThread - 1)] };
+
+						//timestamps are in microseconds, the fraction keeps the nanoseconds
+						std::snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+							isFirst ? "\n" : ",\n", event.name, buffer->threadId, static_cast<double>(event.startTime) / 1000.0, static_cast<double>(event.duration) / 1000.0);
+
+						file << line;
+						isFirst = false;
+					}
+				}
+
+				file << "\n]}\n";
+
+				return static_cast<bool>(file);
+			}
+
+		private:
+			std::mutex m_mutex{};
+			std::vector<std::unique_ptr<ThreadBuffer>> m_buffers{};
+			std::chrono::steady_clock::time_point m_startTime{ std::chrono::steady_clock::now() };
+	};
+
+	Session s_session{};
+
+	ThreadBuffer& getThreadBuffer()
+	{
+		thread_local ThreadBuffer& buffer{ s_session.addThread() };
+		return buffer;
+	}
+}
+
+Trace::Scope::Scope(const char* name)
+	: m_name{ name }, m_startTime{ s_session.getTime() } {}
+
+Trace::Scope::~Scope()
+{
+	ThreadBuffer& buffer{ getThreadBuffer() };
+	const std::uint64_t head{ buffer.head.load(std::memory_order_relaxed) };
+
+	buffer.events[head & (eventsPerThread - 1)] = Event{ m_name, m_startTime, s_session.getTime() - m_startTime };
+	buffer.head.store(head + 1, std::memory_order_release);
+}
+
+bool Trace::flush(std::string_view path)
+{
+	return s_session.flush(path);
+}
+
+#endif
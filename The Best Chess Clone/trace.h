@@ -0,0 +1,42 @@
+#pragma once
+
+//scoped tracing in the Chrome trace event format, open the file in chrome://tracing or ui.perfetto.dev
+//
+//TRACE_SCOPE("name") times the rest of the enclosing block. Every thread writes to its own ring buffer,
+//so recording never takes a lock, and the oldest events are overwritten once a buffer is full.
+//The buffers are written out when the program exits, to $CHESS_TRACE_FILE or chess_trace.json.
+//Without CHESS_TRACE defined the macro expands to nothing and none of this is compiled.
+#ifdef CHESS_TRACE
+
+#include <cstdint>
+#include <string_view>
+
+namespace Trace
+{
+	//names must outlive the program, which string literals do
+	class Scope
+	{
+		public:
+			explicit Scope(const char* name);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			void operator=(const Scope&) = delete;
+
+		private:
+			const char* m_name{};
+			std::uint64_t m_startTime{};
+	};
+
+	bool flush(std::string_view path);
+}
+
+#define TRACE_JOIN_IMPLEMENTATION(first, second) first##second
+#define TRACE_JOIN(first, second) TRACE_JOIN_IMPLEMENTATION(first, second)
+#define TRACE_SCOPE(name) const Trace::Scope TRACE_JOIN(traceScope, __LINE__){ name }
+
+#else
+
+#define TRACE_SCOPE(name)
+
+#endif
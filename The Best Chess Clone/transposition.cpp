@@ -0,0 +1,38 @@
+#include "transposition.h"
+#include "zobrist.h"
+#include "move.h"
+#include "allocTracking.h"
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+	//allocated on a thread's first search, as the pawn table is
+	std::vector<Transposition::Entry>& getTable()
+	{
+		ALLOC_SCOPE("Transposition::getTable");		//a thread's first probe, allowed inside the forbidden scopes
+		thread_local std::vector<Transposition::Entry> table(static_cast<size_t>(Transposition::tableSize));
+		return table;
+	}
+}
+
+const Transposition::Entry* Transposition::find(Zobrist::Key key)
+{
+	ALLOC_FORBID("Transposition::find");
+
+	const Entry& entry{ getTable()[static_cast<size_t>(key & (tableSize - 1))] };
+	return (entry.key == key && entry.deepness >= 0) ? &entry : nullptr;
+}
+
+void Transposition::store(Zobrist::Key key, Move move, int eval, int deepness, Bound bound)
+{
+	ALLOC_FORBID("Transposition::store");
+
+	getTable()[static_cast<size_t>(key & (tableSize - 1))] = Entry{ key, eval, move.getData(), static_cast<std::int8_t>(deepness), bound };
+}
+
+void Transposition::clear()
+{
+	std::fill(getTable().begin(), getTable().end(), Entry{});
+}
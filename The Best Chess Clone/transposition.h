@@ -0,0 +1,37 @@
+#pragma once
+#include "zobrist.h"
+#include "move.h"
+#include <cstdint>
+
+//results of searched positions by key, for move ordering and for skipping positions already searched deep enough
+//
+//like the pawn table each thread has its own, so boards searched in parallel never share entries.
+//An entry is always replaced by the newest search of its slot.
+namespace Transposition
+{
+	inline constexpr int tableSize{ 1 << 18 };		//entries, a power of two
+
+	//what the eval is, as searches with an alpha-beta window only find bounds for most positions
+	enum class Bound : std::uint8_t
+	{
+		Exact,
+		Lower,
+		Upper,
+	};
+
+	struct Entry
+	{
+		Zobrist::Key key{ 0 };
+		std::int32_t eval{ 0 };			//from the side to move
+		std::uint16_t move{ 0 };			//as in Move::getData, empty when no move was best
+		std::int8_t deepness{ -1 };
+		Bound bound{ Bound::Exact };
+	};
+
+	static_assert(sizeof(Entry) == 16);
+
+	//this thread's entry for the key, or nullptr when the table doesn't hold it
+	const Entry* find(Zobrist::Key key);
+	void store(Zobrist::Key key, Move move, int eval, int deepness, Bound bound);
+	void clear();
+}
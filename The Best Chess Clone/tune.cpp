@@ -0,0 +1,403 @@
+#include "board.h"
+#include "piece.h"
+#include "evalParams.h"
+#include "mappedFile.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <thread>
+#include <algorithm>
+#include <optional>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+//Texel tuning of the classical evaluation
+//
+//usage: tune <positions> [--threads n] [--epochs n] [--rate x] [--output path]
+//each line of the positions file holds a FEN followed by the game result, either as
+//[1.0] / [0.5] / [0.0] or as "1-0" / "1/2-1/2" / "0-1", always from white's side
+
+namespace
+{
+	constexpr int materialTerms{ 5 };					//pawn, knight, bishop, rook and queen
+	constexpr int parameterCount{ materialTerms + 1 };	//plus the mobility bonus
+	constexpr double log10Over400{ 2.302585092994046 / 400.0 };
+
+	using Parameters = std::array<double, parameterCount>;
+
+	//the evaluation is linear in its weights, so every position is reduced to its terms once
+	struct TuningPosition
+	{
+		std::array<std::int8_t, materialTerms> materialBalance{};	//from the evaluated side
+		std::uint8_t mobility{};									//of the evaluated side
+		std::int8_t sign{};											//+1 when the evaluated side is white
+		std::uint8_t result{};										//white's score in half points
+		std::int16_t pawnStructure{};								//of the evaluated side, not tuned but part of the eval
+	};
+
+	static_assert(sizeof(TuningPosition) == 10);
+
+	struct Options
+	{
+		std::string positionsPath{};
+		std::string outputPath{ "evalParams.h" };
+		unsigned threads{ std::max(std::thread::hardware_concurrency(), 1u) };
+		int epochs{ 1000 };
+		double rate{ 1.0 };
+	};
+
+	std::optional<Options> parseOptions(int argc, char** argv)
+	{
+		Options options{};
+
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			const std::string_view argument{ argv[i] };
+			const bool hasValue{ i + 1 < argc };
+
+			if (argument == "--threads" && hasValue)
+				options.threads = static_cast<unsigned>(std::max(std::stoi(argv[++i]), 1));
+			else if (argument == "--epochs" && hasValue)
+				options.epochs = std::stoi(argv[++i]);
+			else if (argument == "--rate" && hasValue)
+				options.rate = std::stod(argv[++i]);
+			else if (argument == "--output" && hasValue)
+				options.outputPath = argv[++i];
+			else if (options.positionsPath.empty() && !argument.starts_with("--"))
+				options.positionsPath = argument;
+			else
+				return std::nullopt;
+		}
+
+		if (options.positionsPath.empty())
+			return std::nullopt;
+
+		return options;
+	}
+
+	std::optional<std::uint8_t> parseResult(std::string_view line)
+	{
+		constexpr std::array<std::pair<std::string_view, std::uint8_t>, 6> results
+		{ {
+			{ "[1.0]", 2 }, { "[0.5]", 1 }, { "[0.0]", 0 },
+			{ "1/2-1/2", 1 }, { "1-0", 2 }, { "0-1", 0 },
+		} };
+
+		for (const auto& [text, result] : results)
+			if (line.find(text) != std::string_view::npos)
+				return result;
+
+		return std::nullopt;
+	}
+
+	std::optional<TuningPosition> toTuningPosition(std::string_view line)
+	{
+		const auto result{ parseResult(line) };
+
+		if (!result)
+			return std::nullopt;
+
+		auto board{ Board::fromFen(line, Piece::Color::White) };
+
+		if (!board)
+			return std::nullopt;
+
+		//the search evaluates a position from the side that just moved into it
+		const Piece::Color evaluatedColor{ !board->getColorToMove() };
+		TuningPosition position{};
+
+		for (const auto* piece : board->getPieces())
+		{
+			if (piece->getType() == Piece::Type::King)
+				continue;
+
+			auto& balance{ position.materialBalance[static_cast<size_t>(piece->getType())] };
+			balance = static_cast<std::int8_t>(balance + ((piece->getColor() == evaluatedColor) ? 1 : -1));
+		}
+
+		position.mobility = static_cast<std::uint8_t>(std::min(board->getMobility(evaluatedColor), 255));
+		position.pawnStructure = static_cast<std::int16_t>(board->getPawnEval(evaluatedColor));
+		position.sign = (evaluatedColor == Piece::Color::White) ? 1 : -1;
+		position.result = result.value();
+
+		return position;
+	}
+
+	//every thread parses the lines starting inside its own slice of the file
+	std::vector<TuningPosition> loadPositions(std::string_view text, unsigned threadCount)
+	{
+		std::vector<std::vector<TuningPosition>> slices(threadCount);
+		std::vector<std::thread> threads{};
+
+		const auto findLineStart
+		{
+			[&](size_t offset)
+			{
+				if (offset == 0 || offset >= text.size())
+					return std::min(offset, text.size());
+
+				const size_t newline{ text.find('\n', offset - 1) };
+				return (newline == std::string_view::npos) ? text.size() : newline + 1;
+			}
+		};
+
+		for (unsigned i{ 0 }; i < threadCount; ++i)
+		{
+			threads.emplace_back([&, i]()
+			{
+				size_t position{ findLineStart(text.size() * i / threadCount) };
+				const size_t end{ findLineStart(text.size() * (i + 1) / threadCount) };
+
+				while (position < end)
+				{
+					const size_t lineEnd{ std::min(text.find('\n', position), end) };
+
+					if (auto tuningPosition{ toTuningPosition(text.substr(position, lineEnd - position)) })
+						slices[i].push_back(tuningPosition.value());
+
+					position = lineEnd + 1;
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+			thread.join();
+
+		std::vector<TuningPosition> positions{};
+
+		for (const auto& slice : slices)
+			positions.insert(positions.end(), slice.begin(), slice.end());
+
+		return positions;
+	}
+
+	double evaluate(const TuningPosition& position, const Parameters& parameters)
+	{
+		double eval{ parameters[materialTerms] * position.mobility + position.pawnStructure };
+
+		for (int i{ 0 }; i < materialTerms; ++i)
+			eval += parameters[static_cast<size_t>(i)] * position.materialBalance[static_cast<size_t>(i)];
+
+		return eval * position.sign;
+	}
+
+	double sigmoid(double eval, double scale)
+	{
+		return 1.0 / (1.0 + std::exp(-scale * eval * log10Over400));
+	}
+
+	struct Pass
+	{
+		double error{};
+		Parameters gradient{};
+	};
+
+	//mean squared error and its gradient over all positions, split between the threads
+	Pass runPass(const std::vector<TuningPosition>& positions, const Parameters& parameters, double scale, unsigned threadCount, bool withGradient)
+	{
+		std::vector<Pass> partials(threadCount);
+		std::vector<std::thread> threads{};
+
+		for (unsigned i{ 0 }; i < threadCount; ++i)
+		{
+			threads.emplace_back([&, i]()
+			{
+				const size_t begin{ positions.size() * i / threadCount };
+				const size_t end{ positions.size() * (i + 1) / threadCount };
+				Pass partial{};
+
+				for (size_t j{ begin }; j < end; ++j)
+				{
+					const TuningPosition& position{ positions[j] };
+					const double predicted{ sigmoid(evaluate(position, parameters), scale) };
+					const double difference{ position.result * 0.5 - predicted };
+
+					partial.error += difference * difference;
+
+					if (!withGradient)
+						continue;
+
+					const double factor{ -2.0 * difference * predicted * (1.0 - predicted) * scale * log10Over400 * position.sign };
+
+					for (int k{ 0 }; k < materialTerms; ++k)
+						partial.gradient[static_cast<size_t>(k)] += factor * position.materialBalance[static_cast<size_t>(k)];
+
+					partial.gradient[materialTerms] += factor * position.mobility;
+				}
+
+				partials[i] = partial;	//written once, so the threads don't fight over the same cache lines
+			});
+		}
+
+		for (auto& thread : threads)
+			thread.join();
+
+		Pass total{};
+
+		for (const auto& partial : partials)
+		{
+			total.error += partial.error;
+
+			for (size_t k{ 0 }; k < total.gradient.size(); ++k)
+				total.gradient[k] += partial.gradient[k];
+		}
+
+		const double count{ static_cast<double>(std::max<size_t>(positions.size(), 1)) };
+		total.error /= count;
+
+		for (auto& value : total.gradient)
+			value /= count;
+
+		return total;
+	}
+
+	//golden section search of the sigmoid scale which best fits the current weights
+	double fitScale(const std::vector<TuningPosition>& positions, const Parameters& parameters, unsigned threadCount)
+	{
+		constexpr double goldenRatio{ 0.6180339887498949 };
+		double low{ 0.1 };
+		double high{ 3.0 };
+
+		for (int i{ 0 }; i < 40; ++i)
+		{
+			const double first{ high - goldenRatio * (high - low) };
+			const double second{ low + goldenRatio * (high - low) };
+
+			if (runPass(positions, parameters, first, threadCount, false).error < runPass(positions, parameters, second, threadCount, false).error)
+				high = second;
+			else
+				low = first;
+		}
+
+		return (low + high) / 2.0;
+	}
+
+	bool writeHeader(const std::string& path, const Parameters& parameters, double error, size_t positionCount)
+	{
+		std::ofstream file{ path };
+
+		if (!file)
+			return false;
+
+		const auto round{ [](double value) { return static_cast<int>(std::lround(value)); } };
+		const auto join
+		{
+			[](const auto& values)
+			{
+				std::string text{};
+
+				for (const int value : values)
+					text += (text.empty() ? "" : ", ") + std::to_string(value);
+
+				return text;
+			}
+		};
+
+		file << "#pragma once\n"
+			<< "#include <array>\n\n"
+			<< "//evaluation weights in centipawns, can be regenerated by the tune tool\n"
+			<< "//tuned on " << positionCount << " positions, mean squared error " << error << '\n'
+			<< "namespace EvalParams\n"
+			<< "{\n"
+			<< "\tinline constexpr std::array<int, 6> pieceValues{ "
+			<< round(parameters[0]) << ", " << round(parameters[1]) << ", " << round(parameters[2]) << ", "
+			<< round(parameters[3]) << ", " << round(parameters[4]) << ", 0 };\t//indexed by Piece::Type, the king is never traded\n"
+			<< "\tinline constexpr int mobilityBonus{ " << round(parameters[materialTerms]) << " };\t//per attacked square\n"
+			//the pawn structure terms aren't tuned, they're written back as they are
+			<< "\tinline constexpr int doubledPawnPenalty{ " << EvalParams::doubledPawnPenalty << " };\t//per pawn behind another on its file\n"
+			<< "\tinline constexpr int isolatedPawnPenalty{ " << EvalParams::isolatedPawnPenalty << " };\n"
+			<< "\tinline constexpr int backwardPawnPenalty{ " << EvalParams::backwardPawnPenalty << " };\n"
+			<< "\tinline constexpr std::array<int, 8> passedPawnBonus{ " << join(EvalParams::passedPawnBonus) << " };\t//by rank, counted from the pawn's side\n"
+			<< "\tinline constexpr std::array<int, 2> pawnShieldBonus{ " << join(EvalParams::pawnShieldBonus) << " };\t//per pawn in front of the king, on its second and third ranks\n"
+			<< "}\n";
+
+		return static_cast<bool>(file);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const auto options{ parseOptions(argc, argv) };
+
+	if (!options)
+	{
+		std::cout << "usage: tune <positions> [--threads n] [--epochs n] [--rate x] [--output path]\n";
+		return 1;
+	}
+
+	MappedFile file{};
+
+	if (!file.open(options->positionsPath))
+	{
+		std::cout << "Could not open " << options->positionsPath << '\n';
+		return 1;
+	}
+
+	const auto startTime{ std::chrono::steady_clock::now() };
+	const auto data{ file.getData() };
+	const auto positions{ loadPositions({ reinterpret_cast<const char*>(data.data()), data.size() }, options->threads) };
+	file.close();
+
+	if (positions.empty())
+	{
+		std::cout << "No labelled positions found\n";
+		return 1;
+	}
+
+	std::cout << "Loaded " << positions.size() << " positions in "
+		<< std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() << "s\n";
+
+	Parameters parameters{};
+
+	for (int i{ 0 }; i < materialTerms; ++i)
+		parameters[static_cast<size_t>(i)] = EvalParams::pieceValues[static_cast<size_t>(i)];
+
+	parameters[materialTerms] = EvalParams::mobilityBonus;
+
+	const double scale{ fitScale(positions, parameters, options->threads) };
+	std::cout << "Sigmoid scale " << scale << ", initial error " << runPass(positions, parameters, scale, options->threads, false).error << '\n';
+
+	//Adam, since material and mobility terms have very different magnitudes
+	constexpr double beta1{ 0.9 };
+	constexpr double beta2{ 0.999 };
+	constexpr double epsilon{ 1e-8 };
+	Parameters momentum{};
+	Parameters velocity{};
+	double error{};
+
+	for (int epoch{ 1 }; epoch <= options->epochs; ++epoch)
+	{
+		const Pass pass{ runPass(positions, parameters, scale, options->threads, true) };
+		error = pass.error;
+
+		for (size_t k{ 0 }; k < parameters.size(); ++k)
+		{
+			momentum[k] = beta1 * momentum[k] + (1.0 - beta1) * pass.gradient[k];
+			velocity[k] = beta2 * velocity[k] + (1.0 - beta2) * pass.gradient[k] * pass.gradient[k];
+
+			const double correctedMomentum{ momentum[k] / (1.0 - std::pow(beta1, epoch)) };
+			const double correctedVelocity{ velocity[k] / (1.0 - std::pow(beta2, epoch)) };
+
+			parameters[k] -= options->rate * correctedMomentum / (std::sqrt(correctedVelocity) + epsilon);
+		}
+
+		if (epoch % 100 == 0 || epoch == options->epochs)
+			std::cout << "Epoch " << epoch << ", error " << error << '\n';
+	}
+
+	if (!writeHeader(options->outputPath, parameters, error, positions.size()))
+	{
+		std::cout << "Could not write " << options->outputPath << '\n';
+		return 1;
+	}
+
+	std::cout << "Wrote " << options->outputPath << " after "
+		<< std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() << "s\n";
+
+	return 0;
+}
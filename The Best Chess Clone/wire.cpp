@@ -0,0 +1,188 @@
+#include "wire.h"
+#include "board.h"
+#include "packedPosition.h"
+#include "move.h"
+#include <span>
+#include <optional>
+#include <bit>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+namespace
+{
+	//byte offsets in a position
+	constexpr std::size_t versionOffset{ 0 };
+	constexpr std::size_t stateOffset{ 1 };
+	constexpr std::size_t enPassantOffset{ 2 };
+	constexpr std::size_t halfmoveClockOffset{ 3 };
+	constexpr std::size_t fullmoveOffset{ 4 };
+	constexpr std::size_t reservedOffset{ 6 };
+	constexpr std::size_t occupancyOffset{ 8 };
+	constexpr std::size_t piecesOffset{ 16 };
+
+	constexpr std::uint8_t stateMask{ 0x1f };		//side to move and the four castling rights
+	constexpr int maxPieces{ 32 };
+
+	std::uint16_t readUint16(const std::uint8_t* bytes)
+	{
+		return static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+	}
+
+	std::uint64_t readUint64(const std::uint8_t* bytes)
+	{
+		std::uint64_t value{ 0 };
+
+		for (int i{ 7 }; i >= 0; --i)
+			value = (value << 8) | bytes[i];
+
+		return value;
+	}
+
+	void writeUint16(std::uint8_t* bytes, std::uint16_t value)
+	{
+		bytes[0] = static_cast<std::uint8_t>(value);
+		bytes[1] = static_cast<std::uint8_t>(value >> 8);
+	}
+
+	void writeUint64(std::uint8_t* bytes, std::uint64_t value)
+	{
+		for (int i{ 0 }; i < 8; ++i)
+			bytes[i] = static_cast<std::uint8_t>(value >> (i * 8));
+	}
+
+	//a type from pawn to king, white or black
+	bool isPieceCode(int code)
+	{
+		const int type{ code % PackedPosition::blackBit };
+		return type >= PackedPosition::getCode(Piece::Type::Pawn, Piece::Color::White) && type <= PackedPosition::getCode(Piece::Type::King, Piece::Color::White);
+	}
+}
+
+bool Wire::PositionView::isBlackToMove() const
+{
+	return (getState() & PackedPosition::blackToMove) != 0;
+}
+
+std::uint8_t Wire::PositionView::getState() const
+{
+	return m_bytes[stateOffset];
+}
+
+std::uint8_t Wire::PositionView::getEnPassant() const
+{
+	return m_bytes[enPassantOffset];
+}
+
+std::uint8_t Wire::PositionView::getHalfmoveClock() const
+{
+	return m_bytes[halfmoveClockOffset];
+}
+
+int Wire::PositionView::getFullmoveNumber() const
+{
+	return readUint16(m_bytes + fullmoveOffset);
+}
+
+std::uint64_t Wire::PositionView::getOccupancy() const
+{
+	return readUint64(m_bytes + occupancyOffset);
+}
+
+int Wire::PositionView::getCode(int index) const
+{
+	return (m_bytes[piecesOffset + static_cast<size_t>(index / 2)] >> (index % 2 * 4)) & 0xf;
+}
+
+PackedPosition Wire::PositionView::toPacked() const
+{
+	PackedPosition position{};
+
+	position.occupancy = getOccupancy();
+	std::copy_n(m_bytes + piecesOffset, position.pieces.size(), position.pieces.begin());
+	position.state = getState();
+	position.enPassant = getEnPassant();
+	position.halfmoveClock = getHalfmoveClock();
+
+	return position;
+}
+
+//checks everything a view relies on, whether the pieces make a legal position is left to the board
+std::optional<Wire::PositionView> Wire::readPosition(std::span<const std::uint8_t> bytes)
+{
+	if (bytes.size() < positionSize || bytes[versionOffset] != version)
+		return std::nullopt;
+
+	const PositionView position{ bytes.data() };
+	const int pieceCount{ std::popcount(position.getOccupancy()) };
+
+	if ((position.getState() & ~stateMask) != 0 || position.getEnPassant() > PackedPosition::noEnPassant)
+		return std::nullopt;
+
+	if (bytes[reservedOffset] != 0 || bytes[reservedOffset + 1] != 0 || pieceCount > maxPieces)
+		return std::nullopt;
+
+	for (int index{ 0 }; index < maxPieces; ++index)
+		if ((index < pieceCount) ? !isPieceCode(position.getCode(index)) : position.getCode(index) != 0)
+			return std::nullopt;
+
+	return position;
+}
+
+std::optional<Wire::GameView> Wire::readGame(std::span<const std::uint8_t> bytes)
+{
+	const auto position{ readPosition(bytes) };
+
+	if (!position || bytes.size() < getGameSize(0))
+		return std::nullopt;
+
+	const std::size_t moveCount{ readUint16(bytes.data() + positionSize) };
+
+	if (bytes.size() < getGameSize(moveCount))
+		return std::nullopt;
+
+	return GameView{ position.value(), MovesView{ bytes.data() + getGameSize(0), moveCount } };
+}
+
+std::optional<std::size_t> Wire::writePosition(const PackedPosition& position, int fullmoveNumber, std::span<std::uint8_t> output)
+{
+	if (output.size() < positionSize)
+		return std::nullopt;
+
+	std::uint8_t* bytes{ output.data() };
+
+	bytes[versionOffset] = version;
+	bytes[stateOffset] = position.state;
+	bytes[enPassantOffset] = position.enPassant;
+	bytes[halfmoveClockOffset] = position.halfmoveClock;
+	writeUint16(bytes + fullmoveOffset, static_cast<std::uint16_t>(std::clamp(fullmoveNumber, 1, 0xffff)));
+	writeUint16(bytes + reservedOffset, 0);
+	writeUint64(bytes + occupancyOffset, position.occupancy);
+	std::copy(position.pieces.begin(), position.pieces.end(), bytes + piecesOffset);
+
+	return positionSize;
+}
+
+std::optional<std::size_t> Wire::writePosition(const Board& board, std::span<std::uint8_t> output)
+{
+	return writePosition(board.pack(), board.getFullmoveNumber(), output);
+}
+
+std::optional<std::size_t> Wire::writeGame(const Board& start, std::span<const Move> moves, std::span<std::uint8_t> output)
+{
+	if (moves.size() > maxGameMoves || output.size() < getGameSize(moves.size()) || !writePosition(start, output))
+		return std::nullopt;
+
+	std::uint8_t* bytes{ output.data() + positionSize };
+
+	writeUint16(bytes, static_cast<std::uint16_t>(moves.size()));
+	bytes += moveSize;
+
+	for (const Move move : moves)
+	{
+		writeUint16(bytes, move.getData());
+		bytes += moveSize;
+	}
+
+	return getGameSize(moves.size());
+}
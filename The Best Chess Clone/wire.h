@@ -0,0 +1,110 @@
+#pragma once
+#include "packedPosition.h"
+#include "move.h"
+#include <span>
+#include <optional>
+#include <iterator>
+#include <cstdint>
+#include <cstddef>
+
+class Board;
+
+//binary encoding of positions and games, for exchanging them with other programs
+//
+//a position is 32 bytes: the version, the state (side to move and castling rights, as in PackedPosition),
+//the en passant target square (64 for none), the halfmove clock, the fullmove number as 16 bits, two zero
+//bytes, the occupancy as 64 bits and then PackedPosition's piece nibbles. A game is its starting position,
+//a 16-bit move count and that many moves as in Move::getData. Every number is little-endian.
+//
+//reading doesn't copy or allocate: views point into the buffer they were read from, which has to outlive them
+namespace Wire
+{
+	inline constexpr std::uint8_t version{ 1 };
+	inline constexpr std::size_t positionSize{ 32 };
+	inline constexpr std::size_t moveSize{ 2 };
+	inline constexpr std::size_t maxGameMoves{ 0xffff };
+
+	constexpr std::size_t getGameSize(std::size_t moveCount)
+	{
+		return positionSize + moveSize + moveCount * moveSize;
+	}
+
+	class PositionView
+	{
+		public:
+
+			//only for positionSize bytes which readPosition has checked
+			explicit PositionView(const std::uint8_t* bytes) : m_bytes{ bytes } {}
+
+			bool isBlackToMove() const;
+			std::uint8_t getState() const;
+			std::uint8_t getEnPassant() const;
+			std::uint8_t getHalfmoveClock() const;
+			int getFullmoveNumber() const;
+			std::uint64_t getOccupancy() const;
+			int getCode(int index) const;			//index counts occupied squares, as in PackedPosition
+
+			PackedPosition toPacked() const;
+
+		private:
+
+			const std::uint8_t* m_bytes{};
+	};
+
+	class MovesView
+	{
+		public:
+
+			class Iterator
+			{
+				public:
+
+					using iterator_category = std::forward_iterator_tag;
+					using value_type = Move;
+					using difference_type = std::ptrdiff_t;
+
+					Iterator() = default;
+					explicit Iterator(const std::uint8_t* bytes) : m_bytes{ bytes } {}
+
+					Move operator*() const { return Move::fromData(static_cast<std::uint16_t>(m_bytes[0] | (m_bytes[1] << 8))); }
+					Iterator& operator++() { m_bytes += moveSize; return *this; }
+					Iterator operator++(int) { Iterator previous{ *this }; ++*this; return previous; }
+					bool operator==(const Iterator& iterator) const = default;
+
+				private:
+
+					const std::uint8_t* m_bytes{};
+			};
+
+			MovesView() = default;
+			MovesView(const std::uint8_t* bytes, std::size_t size) : m_bytes{ bytes }, m_size{ size } {}
+
+			std::size_t size() const { return m_size; }
+			bool empty() const { return m_size == 0; }
+			Move operator[](std::size_t index) const { return *Iterator{ m_bytes + index * moveSize }; }
+			Iterator begin() const { return Iterator{ m_bytes }; }
+			Iterator end() const { return Iterator{ m_bytes + m_size * moveSize }; }
+
+		private:
+
+			const std::uint8_t* m_bytes{};
+			std::size_t m_size{ 0 };
+	};
+
+	struct GameView
+	{
+		PositionView position;
+		MovesView moves{};
+
+		std::size_t getSize() const { return getGameSize(moves.size()); }	//bytes taken, the next record starts after them
+	};
+
+	//nullopt when the bytes are too few, of another version or not a position's, anything after it is left alone
+	std::optional<PositionView> readPosition(std::span<const std::uint8_t> bytes);
+	std::optional<GameView> readGame(std::span<const std::uint8_t> bytes);
+
+	//the bytes written, or nullopt when they don't fit in the output
+	std::optional<std::size_t> writePosition(const PackedPosition& position, int fullmoveNumber, std::span<std::uint8_t> output);
+	std::optional<std::size_t> writePosition(const Board& board, std::span<std::uint8_t> output);
+	std::optional<std::size_t> writeGame(const Board& start, std::span<const Move> moves, std::span<std::uint8_t> output);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "constants.h"
+#include <array>
+#include <cstdint>
+
+namespace Zobrist
+{
+	using Key = std::uint64_t;
+
+	inline constexpr int pieceKinds{ 12 };
+
+	struct Tables
+	{
+		std::array<std::array<Key, Constants::array2dSize>, pieceKinds> pieces{};
+		std::array<Key, Constants::array2dSize> unmoved{};		//kings and rooks which can still castle
+		std::array<Key, Constants::array2dSize> enPassant{};
+		Key blackToMove{};
+	};
+
+	constexpr Key splitMix64(Key& state)
+	{
+		state += 0x9E3779B97F4A7C15ull;
+		Key result{ state };
+		result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9ull;
+		result = (result ^ (result >> 27)) * 0x94D049BB133111EBull;
+		return result ^ (result >> 31);
+	}
+
+	constexpr Tables makeTables()
+	{
+		Tables tables{};
+		Key state{ 0x2545F4914F6CDD1Dull };	//fixed seed, so keys are equal between runs and builds
+
+		for (auto& pieceKeys : tables.pieces)
+			for (auto& key : pieceKeys)
+				key = splitMix64(state);
+
+		for (auto& key : tables.unmoved)
+			key = splitMix64(state);
+
+		for (auto& key : tables.enPassant)
+			key = splitMix64(state);
+
+		tables.blackToMove = splitMix64(state);
+
+		return tables;
+	}
+
+	inline constexpr Tables tables{ makeTables() };
+
+	constexpr int getPieceIndex(char letter)
+	{
+		switch (letter)
+		{
+			case 'p': return 0;
+			case 'n': return 1;
+			case 'b': return 2;
+			case 'r': return 3;
+			case 'q': return 4;
+			case 'k': return 5;
+			case 'P': return 6;
+			case 'N': return 7;
+			case 'B': return 8;
+			case 'R': return 9;
+			case 'Q': return 10;
+		}
+
+		return 11;
+	}
+
+	constexpr Key getPieceKey(char letter, int square)
+	{
+		return tables.pieces[static_cast<size_t>(getPieceIndex(letter))][static_cast<size_t>(square)];
+	}
+}